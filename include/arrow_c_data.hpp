@@ -0,0 +1,106 @@
+#ifndef ASOF_JOIN_ARROW_C_DATA_HPP
+#define ASOF_JOIN_ARROW_C_DATA_HPP
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "relation.hpp"
+
+/// Structs of the Arrow C Data Interface, see
+/// https://arrow.apache.org/docs/format/CDataInterface.html.
+/// Guarded by the same macro as in the specification such that it can be mixed with Arrow headers.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+}
+
+#endif // ARROW_C_DATA_INTERFACE
+
+/// Import and export of relations as Arrow struct arrays with the columns of our csv format:
+/// <timestamp: uint64, stock_id: utf8, value: uint64>.
+/// 64 bit signed integers and timestamps are accepted for the numeric columns and large utf8
+/// for the stock ids. Columns are matched by position, nulls are not supported.
+namespace arrow_c {
+    /// Zero-copy view on an imported struct array. Takes ownership of [[array]] and [[schema]],
+    /// i.e. moves them and calls their release callbacks on destruction.
+    /// Throws if the array does not match the expected layout.
+    class ImportedRelation {
+    public:
+        ImportedRelation(ArrowArray* array, ArrowSchema* schema);
+        ~ImportedRelation();
+
+        ImportedRelation(const ImportedRelation& other) = delete;
+        ImportedRelation& operator=(const ImportedRelation& other) = delete;
+
+        [[nodiscard]] size_t num_rows() const { return size; }
+
+        [[nodiscard]] std::span<const uint64_t> timestamps() const { return {timestamps_data, size}; }
+        [[nodiscard]] std::span<const uint64_t> values() const { return {values_data, size}; }
+
+        [[nodiscard]] std::string_view stock_id(size_t row) const {
+            uint64_t begin = large_offsets ? large_offsets[row] : offsets[row];
+            uint64_t end = large_offsets ? large_offsets[row + 1] : offsets[row + 1];
+            return {stock_id_data + begin, end - begin};
+        }
+
+    private:
+        ArrowArray array;
+        ArrowSchema schema;
+
+        size_t size;
+        const uint64_t* timestamps_data;
+        const uint64_t* values_data;
+        const int32_t* offsets = nullptr;
+        const int64_t* large_offsets = nullptr;
+        const char* stock_id_data;
+    };
+
+    /// Import into an owning relation. Symbols are encoded with [[SymbolDictionary::shared()]].
+    /// Takes ownership of [[array]] and [[schema]].
+    Prices import_prices(ArrowArray* array, ArrowSchema* schema);
+    OrderBook import_order_book(ArrowArray* array, ArrowSchema* schema);
+
+    /// Export the relation. The timestamp and value buffers point into the relation without
+    /// copying, so the relation must outlive the exported array. The stock ids are converted to utf8.
+    void export_prices(const Prices& prices, ArrowArray* array, ArrowSchema* schema);
+    void export_order_book(const OrderBook& order_book, ArrowArray* array, ArrowSchema* schema);
+
+    /// Export the collected rows of [[result]] with the columns of [[result_writer::write_csv]], i.e.
+    /// <price_timestamp, stock_id, price, order_book_timestamp, amount, value>. The exported array owns
+    /// copies of the rows. The price timestamp, price and value of unmatched orders are null.
+    void export_result(ResultRelation& result, ArrowArray* array, ArrowSchema* schema);
+} // namespace arrow_c
+
+#endif // ASOF_JOIN_ARROW_C_DATA_HPP
@@ -14,6 +14,8 @@ enum Comparison {
     EQUAL,
     GREATER_THAN,
     GREATER_EQUAL_THEN,
+    /// Closest timestamp in either direction.
+    NEAREST,
 };
 
 enum JoinType {
@@ -22,12 +24,45 @@ enum JoinType {
     RIGHT
 };
 
+/// When the payload of a result row is fetched from the input relations.
+enum Materialization {
+    /// During the probe, i.e. every match copies its full row into the result.
+    EAGER,
+    /// After the probe, which only emits (order_idx, price_idx) pairs, see [[ResultRelation::insert_match]].
+    LATE,
+    /// Never, matches are folded into per stock aggregates, see [[ResultRelation::aggregate]].
+    AGGREGATE
+};
+
+/// How the partitioning joins search the bins for the rows of the probe relation.
+enum ProbeMode {
+    /// One search per row in input order.
+    PROBE_SINGLE,
+    /// Rows of a morsel are sorted by stock and timestamp and merged into each bin, see [[sort_probes]].
+    PROBE_BATCHED,
+    /// Multiple searches are advanced in lock-step with prefetching, see [[interleaved_search]].
+    PROBE_INTERLEAVED,
+    /// Large bins are searched branchless on their Eytzinger layout, see [[layout_search]].
+    PROBE_EYTZINGER,
+    /// Large bins are searched on a k-ary tree with SIMD node comparisons, see [[layout_search]].
+    PROBE_KARY,
+    /// Large bins are searched with a RadixSpline learned index and a bounded last mile, see [[layout_search]].
+    PROBE_LEARNED
+};
+
 class ASOFJoin {
 public:
+    /// No tolerance, i.e. prices match regardless of their distance to the order.
+    static constexpr uint64_t NO_MAX_LAG = UINT64_MAX;
+
+    /// A price only matches an order if their timestamps differ by at most [[max_lag]].
     ASOFJoin(Prices& prices, OrderBook& order_book,
-             Comparison comp_type, JoinType join_type):
+             Comparison comp_type, JoinType join_type,
+             uint64_t max_lag = NO_MAX_LAG,
+             Materialization materialization = EAGER):
         prices(prices), order_book(order_book),
-        comp_type(comp_type), join_type(join_type) {}
+        comp_type(comp_type), join_type(join_type), max_lag(max_lag),
+        materialization(materialization) {}
 
     virtual void join() = 0;
 
@@ -54,6 +89,45 @@ protected:
     OrderBook& order_book;
     Comparison comp_type;
     JoinType join_type;
+    uint64_t max_lag;
+    Materialization materialization;
+
+    /// Emit the match of the order at [[order_idx]] with the price at [[price_idx]] into [[result]].
+    [[gnu::always_inline]] inline void emit_match(size_t order_idx, size_t price_idx) {
+        if (materialization == LATE) {
+            result.insert_match(order_idx, price_idx);
+            return;
+        }
+        if (materialization == AGGREGATE) {
+            result.aggregate(order_book.symbol_ids[order_idx], prices.prices[price_idx], order_book.amounts[order_idx]);
+            return;
+        }
+        result.insert(
+            /* price_timestamp= */ prices.timestamps[price_idx],
+            /* price_stock_id= */ prices.stock_ids[price_idx],
+            /* price= */ prices.prices[price_idx],
+            /* order_book_timestamp= */ order_book.timestamps[order_idx],
+            /* order_book_stock_id= */ order_book.stock_ids[order_idx],
+            /* order_book_symbol_id= */ order_book.symbol_ids[order_idx],
+            /* amount= */ order_book.amounts[order_idx]);
+    }
+
+    /// Emit the order at [[order_idx]] without a matching price for LEFT OUTER joins.
+    [[gnu::always_inline]] inline void emit_unmatched(size_t order_idx) {
+        if (materialization == LATE) {
+            result.insert_match(order_idx, ResultRelation::NO_MATCH);
+            return;
+        }
+        if (materialization == AGGREGATE) {
+            result.aggregate_unmatched();
+            return;
+        }
+        result.insert_unmatched(
+            /* order_book_timestamp= */ order_book.timestamps[order_idx],
+            /* order_book_stock_id= */ order_book.stock_ids[order_idx],
+            /* order_book_symbol_id= */ order_book.symbol_ids[order_idx],
+            /* amount= */ order_book.amounts[order_idx]);
+    }
 };
 
 class BaselineASOFJoin : public ASOFJoin {
@@ -84,6 +158,93 @@ public:
     [[nodiscard]] std::string_view get_strategy_name() const override {
         return "PARTITION RIGHT";
     }
+
+protected:
+    [[nodiscard]] virtual ProbeMode probe_mode() const {
+        return PROBE_SINGLE;
+    }
+
+private:
+    /// Join kernel specialized for the comparison [[comp]].
+    template<Comparison comp>
+    void join_impl();
+};
+
+/// [[PartitioningRightASOFJoin]] which sorts the probes of every morsel by stock and timestamp and
+/// resolves them with a single galloping merge pass per bin, turning random searches into sequential scans.
+class PartitioningRightBatchedASOFJoin : public PartitioningRightASOFJoin {
+public:
+    using PartitioningRightASOFJoin::PartitioningRightASOFJoin;
+
+    [[nodiscard]] std::string_view get_strategy_name() const override {
+        return "PARTITION RIGHT BATCHED";
+    }
+
+protected:
+    [[nodiscard]] ProbeMode probe_mode() const override {
+        return PROBE_BATCHED;
+    }
+};
+
+/// [[PartitioningRightASOFJoin]] which keeps multiple bin searches in flight with software prefetching,
+/// such that their cache misses overlap.
+class PartitioningRightInterleavedASOFJoin : public PartitioningRightASOFJoin {
+public:
+    using PartitioningRightASOFJoin::PartitioningRightASOFJoin;
+
+    [[nodiscard]] std::string_view get_strategy_name() const override {
+        return "PARTITION RIGHT INTERLEAVED";
+    }
+
+protected:
+    [[nodiscard]] ProbeMode probe_mode() const override {
+        return PROBE_INTERLEAVED;
+    }
+};
+
+/// [[PartitioningRightASOFJoin]] which searches large bins on a key-only Eytzinger layout.
+class PartitioningRightEytzingerASOFJoin : public PartitioningRightASOFJoin {
+public:
+    using PartitioningRightASOFJoin::PartitioningRightASOFJoin;
+
+    [[nodiscard]] std::string_view get_strategy_name() const override {
+        return "PARTITION RIGHT EYTZINGER";
+    }
+
+protected:
+    [[nodiscard]] ProbeMode probe_mode() const override {
+        return PROBE_EYTZINGER;
+    }
+};
+
+/// [[PartitioningRightASOFJoin]] which searches large bins on a pointer-free k-ary tree of their timestamps.
+class PartitioningRightKAryASOFJoin : public PartitioningRightASOFJoin {
+public:
+    using PartitioningRightASOFJoin::PartitioningRightASOFJoin;
+
+    [[nodiscard]] std::string_view get_strategy_name() const override {
+        return "PARTITION RIGHT KARY";
+    }
+
+protected:
+    [[nodiscard]] ProbeMode probe_mode() const override {
+        return PROBE_KARY;
+    }
+};
+
+/// [[PartitioningRightASOFJoin]] which searches large bins with a learned index of their timestamps.
+class PartitioningRightLearnedASOFJoin : public PartitioningRightASOFJoin {
+public:
+    using PartitioningRightASOFJoin::PartitioningRightASOFJoin;
+
+    [[nodiscard]] std::string_view get_strategy_name() const override {
+        return "PARTITION RIGHT LEARNED";
+    }
+
+protected:
+    [[nodiscard]] ProbeMode probe_mode() const override {
+        return PROBE_LEARNED;
+    }
 };
 
 class PartitioningLeftASOFJoin : public ASOFJoin {
@@ -94,6 +255,78 @@ public:
     [[nodiscard]] std::string_view get_strategy_name() const override {
         return "PARTITION LEFT";
     }
+
+protected:
+    [[nodiscard]] virtual ProbeMode probe_mode() const {
+        return PROBE_SINGLE;
+    }
+
+private:
+    /// Join kernel specialized for the comparison [[comp]].
+    template<Comparison comp>
+    void join_impl();
+};
+
+/// [[PartitioningLeftASOFJoin]] which sorts the probes of every morsel by stock and timestamp and
+/// resolves them with a single galloping merge pass per bin, turning random searches into sequential scans.
+class PartitioningLeftBatchedASOFJoin : public PartitioningLeftASOFJoin {
+public:
+    using PartitioningLeftASOFJoin::PartitioningLeftASOFJoin;
+
+    [[nodiscard]] std::string_view get_strategy_name() const override {
+        return "PARTITION LEFT BATCHED";
+    }
+
+protected:
+    [[nodiscard]] ProbeMode probe_mode() const override {
+        return PROBE_BATCHED;
+    }
+};
+
+/// [[PartitioningLeftASOFJoin]] which keeps multiple bin searches in flight with software prefetching,
+/// such that their cache misses overlap.
+class PartitioningLeftInterleavedASOFJoin : public PartitioningLeftASOFJoin {
+public:
+    using PartitioningLeftASOFJoin::PartitioningLeftASOFJoin;
+
+    [[nodiscard]] std::string_view get_strategy_name() const override {
+        return "PARTITION LEFT INTERLEAVED";
+    }
+
+protected:
+    [[nodiscard]] ProbeMode probe_mode() const override {
+        return PROBE_INTERLEAVED;
+    }
+};
+
+/// [[PartitioningLeftASOFJoin]] which searches large bins on a key-only Eytzinger layout.
+class PartitioningLeftEytzingerASOFJoin : public PartitioningLeftASOFJoin {
+public:
+    using PartitioningLeftASOFJoin::PartitioningLeftASOFJoin;
+
+    [[nodiscard]] std::string_view get_strategy_name() const override {
+        return "PARTITION LEFT EYTZINGER";
+    }
+
+protected:
+    [[nodiscard]] ProbeMode probe_mode() const override {
+        return PROBE_EYTZINGER;
+    }
+};
+
+/// [[PartitioningLeftASOFJoin]] which searches large bins with a learned index of their timestamps.
+class PartitioningLeftLearnedASOFJoin : public PartitioningLeftASOFJoin {
+public:
+    using PartitioningLeftASOFJoin::PartitioningLeftASOFJoin;
+
+    [[nodiscard]] std::string_view get_strategy_name() const override {
+        return "PARTITION LEFT LEARNED";
+    }
+
+protected:
+    [[nodiscard]] ProbeMode probe_mode() const override {
+        return PROBE_LEARNED;
+    }
 };
 
 class PartitioningSortedMergeJoin : public ASOFJoin {
@@ -104,6 +337,11 @@ public:
     [[nodiscard]] std::string_view get_strategy_name() const override {
         return "PARTITION SORTED MERGE";
     }
+
+private:
+    /// Join kernel specialized for the comparison [[comp]].
+    template<Comparison comp>
+    void join_impl();
 };
 
 class PartitioningRightBTreeASOFJoin : public ASOFJoin {
@@ -166,6 +404,57 @@ public:
     }
 };
 
+/// Input statistics the [[AdaptiveASOFJoin]] bases its plan on.
+struct JoinEstimates {
+    size_t num_prices;
+    size_t num_orders;
+    /// Number of distinct stocks in a sample of both relations.
+    size_t num_stocks;
+    /// Time ranges of both relations. Together with the max lag they bound the probes which search a bin.
+    uint64_t min_price_timestamp;
+    uint64_t max_price_timestamp;
+    uint64_t min_order_timestamp;
+    uint64_t max_order_timestamp;
+    /// Fraction of the sampled orders before the first price, which never match a backward comparison.
+    double orders_before_prices;
+};
+
+/// Estimates the input statistics with min/max scans and sampling and dispatches to the
+/// join strategy with the lowest estimated cost.
+class AdaptiveASOFJoin : public ASOFJoin {
+public:
+    using ASOFJoin::ASOFJoin;
+    void join() override;
+
+    [[nodiscard]] std::string_view get_strategy_name() const override {
+        return "ADAPTIVE";
+    }
+
+    enum Strategy {
+        PARTITION_RIGHT,
+        PARTITION_LEFT,
+        PARTITION_SORTED_MERGE,
+        PARTITION_RIGHT_FILTER_MIN
+    };
+
+    /// Number of rows per relation sampled to estimate the number of stocks and the overlap.
+    static constexpr size_t SAMPLE_SIZE = 1 << 16;
+
+    static JoinEstimates estimate(const Prices& prices, const OrderBook& order_book);
+
+    /// Cheapest strategy which supports the comparison, join type, max lag and materialization.
+    static Strategy choose_strategy(const JoinEstimates& estimates, Comparison comp_type, JoinType join_type,
+                                    uint64_t max_lag, Materialization materialization);
+
+    /// Strategy chosen by the last call of [[join]].
+    [[nodiscard]] Strategy get_plan() const {
+        return plan;
+    }
+
+private:
+    Strategy plan = PARTITION_RIGHT;
+};
+
 struct ASOFJoin::RightEntry : JoinEntry {
     uint64_t timestamp;
     size_t idx;
@@ -233,10 +522,13 @@ struct ASOFJoin::LeftEntry : JoinEntry {
         return *this;
     }
 
-    void inline lock_compare_swap_diffs(uint64_t new_diff, uint64_t new_price_idx) {
+    /// Keep the closest price. Of equally close prices the later row is kept if [[last_tie]], otherwise
+    /// the earlier one, see [[ComparisonTraits::LAST_TIE]].
+    void inline lock_compare_swap_diffs(uint64_t new_diff, uint64_t new_price_idx, bool last_tie = true) {
         /// Use (spin) lock while comparing and exchanging the diff and price idx.
         lock.lock();
-        if (new_diff < diff) {
+        if (new_diff < diff ||
+                (new_diff == diff && (last_tie ? new_price_idx > price_idx : new_price_idx < price_idx))) {
             diff = new_diff;
             price_idx = new_price_idx;
         }
@@ -29,6 +29,10 @@ namespace benchmarks {
 
     void run_increasing_partitions();
 
+    void run_loading_throughput();
+
+    void run_eager_vs_late_materialization();
+
     void run_all();
 
     void run_benchmark(Prices& prices, OrderBook& order_book, size_t num_runs);
@@ -1,257 +1,176 @@
 #ifndef ASOF_JOIN_BTREE_HPP
 #define ASOF_JOIN_BTREE_HPP
 
+#include <algorithm>
+#include <array>
 #include <iostream>
-#include <optional>
+#include <span>
 #include <vector>
 
 #include "asof_join.hpp"
 
-#include "tbb/enumerable_thread_specific.h"
 #include "tbb/parallel_for.h"
-#include "tbb/parallel_for_each.h"
 
+/// Bulk-loaded, pointer-free B+-tree over the keys of a sorted bin.
+///
+/// All nodes live in one cache line aligned arena, stored level by level from the root down, such that
+/// the children of node [[j]] of a level are the nodes [j * NODE_KEYS, (j + 1) * NODE_KEYS) of the level
+/// below. Nodes only hold keys: an inner node stores the minimal key of each child, and the payload of
+/// slot [[i]] of leaf [[j]] is the entry at position [[j * NODE_KEYS + i]] of the bin itself. The tree
+/// therefore neither copies nor owns the entries, so the bin has to outlive it and must not change.
+/// Slots after the last key are padded with the maximal key.
 template<typename Entry,
     typename=std::enable_if<std::is_base_of<ASOFJoin::JoinEntry, Entry>::value>::type>
 class Btree {
-    struct Node; struct InnerNode; struct LeafNode;
     using KeyT = uint64_t;
-    using iterator = std::vector<LeafNode*>::iterator;
 
 public:
-    explicit Btree(std::vector<Entry>& data) {
-        auto nodes = build_leaf_nodes(data);
-        while (nodes.size() > 1) {
-            nodes = build_inner_nodes(nodes);
-        }
-        root = nodes.front();
-    }
+    /// Keys of a node, which fill exactly one cache line. Also the fan-out of the inner nodes.
+    static constexpr size_t NODE_KEYS = 8;
+    /// Larger bins fill every level of the tree in parallel.
+    static constexpr size_t MIN_PARALLEL_BUILD_SIZE = 1 << 16;
 
-    Btree(): root(nullptr) {}
+    explicit Btree(std::vector<Entry>& data): data(&data) {
+        build();
+    }
 
-    ~Btree() { /*delete_tree(root);*/ }
+    Btree() = default;
 
     Entry* find_less_equal_than(KeyT target) {
-        Node* node = root;
-        while (node && !node->is_leaf()) {
-            auto* inner = static_cast<InnerNode*>(node);
-            node = inner->get_closest_child_smaller_equal(target);
-        }
-
-        if (!node) {
-            return nullptr;
-        }
-
-        auto* leaf = static_cast<LeafNode*>(node);
-        return leaf->get_closest_entry_less_equal(target);
+        size_t upper = target == UINT64_MAX ? size() : lower_bound(target + 1);
+        return upper > 0 ? &(*data)[upper - 1] : nullptr;
     }
 
     Entry* find_greater_equal_than(KeyT target) {
-        Node* node = root;
-        while (node && !node->is_leaf()) {
-            auto* inner = static_cast<InnerNode*>(node);
-            node = inner->get_closest_child_greater_equal(target);
-        }
-
-        if (!node) {
-            return nullptr;
-        }
-
-        auto* leaf = static_cast<LeafNode*>(node);
-        return leaf->get_closest_entry_greater_equal(target);
+        size_t lower = lower_bound(target);
+        return lower < size() ? &(*data)[lower] : nullptr;
     }
 
     void print_tree() {
-        print_tree(root);
-    }
-
-    [[nodiscard]] inline iterator leaves_begin() {
-        return leaf_nodes.begin();
+        for (size_t level = 0; level < height; ++level) {
+            std::cout << (level + 1 == height ? "Leaf Nodes: " : "Inner Nodes: ") << std::endl;
+            for (size_t j = level_offsets[level]; j < level_offsets[level + 1]; ++j) {
+                for (auto key : nodes[j].keys) {
+                    if (key != UINT64_MAX) {
+                        std::cout << "key: " << key << ", ";
+                    }
+                }
+                std::cout << std::endl;
+            }
+        }
     }
 
-    [[nodiscard]] inline iterator leaves_end() {
-        return leaf_nodes.end();
+    [[nodiscard]] size_t size() const {
+        return data == nullptr ? 0 : data->size();
     }
 
     [[nodiscard]] size_t num_leaves() const {
-        return leaf_nodes.size();
+        return height == 0 ? 0 : level_offsets[height] - level_offsets[height - 1];
     }
 
-    [[nodiscard]] inline std::vector<Entry>& operator[](size_t idx) {
-        return leaf_nodes[idx]->data;
+    /// Entries of the leaf [[idx]] in the bin.
+    [[nodiscard]] inline std::span<Entry> operator[](size_t idx) {
+        size_t begin = idx * NODE_KEYS;
+        return {data->data() + begin, std::min(NODE_KEYS, size() - begin)};
     }
 
 private:
-    static constexpr size_t capacity = 32;
-    Node* root;
-    std::vector<LeafNode*> leaf_nodes;
-
-    struct Node {
-        size_t level;
-        size_t count;
-
-        Node(size_t level, size_t count): level(level), count(count) {}
-
-        virtual ~Node() = default;
-
-        [[nodiscard]] inline bool is_leaf() const { return level == 0; }
-
-        virtual KeyT get_min_key() = 0;
+    struct alignas(64) Node {
+        std::array<KeyT, NODE_KEYS> keys;
     };
 
-    struct InnerNode: Node {
-        std::array<KeyT, capacity> keys;
-        std::array<Node*, capacity + 1> children;
-
-        explicit InnerNode(size_t level): Node(level, /* count= */ 0), keys(), children() {}
+    /// A tree of that height indexes more than 2^64 keys.
+    static constexpr size_t MAX_HEIGHT = 22;
 
-        ~InnerNode() override = default;
-
-        inline KeyT get_min_key() override {
-            return children[0]->get_min_key();
-        }
+    std::vector<Entry>* data = nullptr;
+    std::vector<Node> nodes;
+    size_t height = 0;
+    /// Level [[l]] is nodes [level_offsets[l], level_offsets[l + 1]), the root is level 0.
+    std::array<size_t, MAX_HEIGHT + 1> level_offsets{};
 
-        Node* get_closest_child_smaller_equal(const KeyT& target) {
-            auto end = keys.begin() + this->count;
-            auto iter = std::upper_bound(keys.begin(), end, target);
-            return children[iter - keys.begin()];
+    [[gnu::always_inline]] static inline size_t count_less(const Node& node, KeyT target) {
+        size_t count = 0;
+        for (size_t i = 0; i < NODE_KEYS; ++i) {
+            count += node.keys[i] < target;
         }
+        return count;
+    }
 
-        Node* get_closest_child_greater_equal(const KeyT& target) {
-            auto end = keys.begin() + this->count;
-            auto iter = std::lower_bound(keys.begin(), end, target);
-            return children[iter - keys.begin()];
-        }
-    };
-
-    struct LeafNode: Node {
-        std::vector<Entry> data;
-        LeafNode* prev;
-        LeafNode* next;
-
-        LeafNode(): Node(/* level= */ 0, /* count= */ 0), data(), prev(nullptr), next(nullptr) {
-            data.reserve(capacity);
-        }
-
-        ~LeafNode() override = default;
-
-        inline KeyT get_min_key() override {
-            return data[0].get_key();
+    /// Position in the bin of the first key >= [[target]], or the bin size.
+    [[nodiscard]] size_t lower_bound(KeyT target) const {
+        if (height == 0) {
+            return 0;
         }
 
-        Entry* get_closest_entry_less_equal(const KeyT& target) {
-            auto end = data.begin() + this->count;
-            auto iter = std::upper_bound(data.begin(), end, target,
-                [](const KeyT& value, const Entry& entry) {
-                    return value < entry.get_key();
-            });
-
-            return iter != data.begin()
-                ? &*--iter
-                : nullptr;
+        /// Descend into the last child whose minimum is smaller than the target. All keys of the following
+        /// child are >= target, so the answer is either in that child or the first position after it.
+        size_t j = 0;
+        for (size_t level = 0; level + 1 < height; ++level) {
+            size_t rank = count_less(nodes[level_offsets[level] + j], target);
+            j = j * NODE_KEYS + (rank > 0 ? rank - 1 : 0);
         }
-
-        Entry* get_closest_entry_greater_equal(const KeyT& target) {
-            auto iter = std::lower_bound(data.begin(), data.end(), target,
-                [](const Entry& entry, const KeyT& value) {
-                    return entry.get_key() < value;
-            });
-
-            if (iter != data.end()) {
-                return &*iter;
-            } else if (next != nullptr) {
-                return next->get_closest_entry_greater_equal(target);
-            }
-
-            return nullptr;
-            }
-    };
-
-    std::vector<Node*> build_leaf_nodes(std::vector<Entry>& entries) {
-        std::vector<Node*> leaves;
-        LeafNode* prev_leaf = nullptr;
-        for (size_t i = 0; i < entries.size(); i += capacity) {
-            auto* curr_leaf = new LeafNode();
-            size_t end = std::min(i + capacity, entries.size());
-            curr_leaf->data.assign(entries.begin() + i, entries.begin() + end);
-            curr_leaf->count = end - i;
-            if (prev_leaf != nullptr) {
-                prev_leaf->next = curr_leaf;
-                curr_leaf->prev = prev_leaf;
-            }
-            prev_leaf = curr_leaf;
-
-            leaves.push_back(curr_leaf);
-            leaf_nodes.push_back(curr_leaf);
-        }
-        return leaves;
+        return j * NODE_KEYS + count_less(nodes[level_offsets[height - 1] + j], target);
     }
 
-    std::vector<Node*> build_inner_nodes(std::vector<Node*>& children) {
-        std::vector<Node*> parents;
-        size_t next_level = children[0]->level + 1;
-        for (size_t i = 0; i < children.size(); i += capacity) {
-            auto* parent = new InnerNode(next_level);
-            size_t end = std::min(i + capacity, children.size());
-            std::copy(
-                children.begin() + i,
-                children.begin() + end,
-                parent->children.begin());
-
-            size_t count = end - i;
-            parent->count = count - 1;
-
-            for (size_t j = 0; j < parent->count; ++j) {
-                parent->keys[j] = parent->children[j + 1]->get_min_key();
+    template<typename Body>
+    static void for_each_node(size_t num_nodes, bool parallel, Body&& body) {
+        if (parallel) {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, num_nodes), [&](tbb::blocked_range<size_t>& range) {
+                for (size_t j = range.begin(); j < range.end(); ++j) {
+                    body(j);
+                }
+            });
+        } else {
+            for (size_t j = 0; j < num_nodes; ++j) {
+                body(j);
             }
-
-            parents.push_back(parent);
         }
-        return parents;
     }
 
-    void print_tree(Node* node) {
-        if (!node) {
+    /// Allocate all levels at once and fill them bottom up, i.e. the leaves from the bin and every
+    /// inner node from the first keys of its children.
+    void build() {
+        const size_t n = size();
+        if (n == 0) {
             return;
         }
 
-        if (node->is_leaf()) {
-            auto* leaf = static_cast<LeafNode*>(node);
-            std::cout << "Leaf Node: " << std::endl;
-
-            for (auto& e : leaf->data) {
-                std::cout << e.str() << ", ";
-            }
-            std::cout << std::endl;
-
-        }  else {
-            auto* inner = static_cast<InnerNode*>(node);
-            std::cout << "Inner Node" << std::endl;
-
-            for (size_t i = 0; i < inner->count; ++i) {
-                std::cout << "key: " << inner->keys[i] << ", ";
-            }
-            std::cout << std::endl;
-
-            for (size_t i = 0; i < inner->count + 1; ++i) {
-                print_tree(inner->children[i]);
-            }
+        std::array<size_t, MAX_HEIGHT> level_sizes{};
+        level_sizes[0] = (n + NODE_KEYS - 1) / NODE_KEYS;
+        height = 1;
+        while (level_sizes[height - 1] > 1) {
+            level_sizes[height] = (level_sizes[height - 1] + NODE_KEYS - 1) / NODE_KEYS;
+            ++height;
         }
-    }
 
-    void delete_tree(Node* node) {
-        if (!node) {
-            return;
+        size_t offset = 0;
+        for (size_t level = 0; level < height; ++level) {
+            level_offsets[level] = offset;
+            offset += level_sizes[height - 1 - level];
         }
+        level_offsets[height] = offset;
+        nodes.resize(offset);
 
-        if (!node->is_leaf()) {
-            auto* inner = static_cast<InnerNode*>(node);
-            for (size_t i = 0; i < inner->count + 1; ++i) {
-                delete_tree(inner->children[i]);
+        const bool parallel = n >= MIN_PARALLEL_BUILD_SIZE;
+        Node* leaves = nodes.data() + level_offsets[height - 1];
+        for_each_node(num_leaves(), parallel, [&](size_t j) {
+            for (size_t i = 0; i < NODE_KEYS; ++i) {
+                size_t pos = j * NODE_KEYS + i;
+                leaves[j].keys[i] = pos < n ? (*data)[pos].get_key() : UINT64_MAX;
             }
+        });
+
+        for (size_t level = height - 1; level-- > 0;) {
+            Node* parents = nodes.data() + level_offsets[level];
+            const Node* children = nodes.data() + level_offsets[level + 1];
+            const size_t num_children = level_offsets[level + 2] - level_offsets[level + 1];
+            for_each_node(level_offsets[level + 1] - level_offsets[level], parallel, [&](size_t j) {
+                for (size_t c = 0; c < NODE_KEYS; ++c) {
+                    size_t child = j * NODE_KEYS + c;
+                    parents[j].keys[c] = child < num_children ? children[child].keys[0] : UINT64_MAX;
+                }
+            });
         }
-
-        delete node;
     }
 };
 
@@ -0,0 +1,78 @@
+#ifndef ASOF_JOIN_COLUMNAR_FILE_HPP
+#define ASOF_JOIN_COLUMNAR_FILE_HPP
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "mmap_file.hpp"
+#include "relation.hpp"
+#include "symbol_dictionary.hpp"
+
+/// Native columnar file format for [[Prices]] and [[OrderBook]].
+///
+/// Layout (all offsets in bytes from the start of the file, every section 64 byte aligned):
+///   [[ColumnarHeader]]
+///   timestamps:  uint64_t[num_rows]
+///   values:      uint64_t[num_rows]  (prices or amounts)
+///   symbol_ids:  SymbolId[num_rows]  (ids into the dictionary of the file)
+///   dictionary:  uint64_t[num_symbols + 1] string offsets, followed by the symbol bytes
+namespace columnar {
+    constexpr std::string_view FILE_EXTENSION = ".col";
+    constexpr char MAGIC[8] = {'A', 'S', 'O', 'F', 'C', 'O', 'L', '\0'};
+    constexpr uint32_t VERSION = 1;
+    constexpr size_t SECTION_ALIGNMENT = 64;
+
+    struct ColumnarHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t symbol_id_size;
+        uint64_t num_rows;
+        uint64_t num_symbols;
+        uint64_t timestamps_offset;
+        uint64_t values_offset;
+        uint64_t symbol_ids_offset;
+        uint64_t dictionary_offset;
+    };
+
+    /// Read-only view on a columnar file. The file is only mapped, so the columns are
+    /// exposed without copying and pages are faulted in on first access.
+    class ColumnarFile {
+    public:
+        /// Throws if [[path]] is not a valid columnar file.
+        explicit ColumnarFile(std::string_view path);
+
+        [[nodiscard]] size_t num_rows() const { return header->num_rows; }
+        [[nodiscard]] size_t num_symbols() const { return header->num_symbols; }
+
+        [[nodiscard]] std::span<const uint64_t> timestamps() const;
+        [[nodiscard]] std::span<const uint64_t> values() const;
+        /// Ids into the dictionary of this file, see [[symbol]].
+        [[nodiscard]] std::span<const SymbolId> symbol_ids() const;
+
+        /// [[id]] has to be smaller than [[num_symbols()]].
+        [[nodiscard]] std::string_view symbol(SymbolId id) const { return dictionary.symbol(id); }
+
+    private:
+        MemoryMappedFile file;
+        const ColumnarHeader* header;
+        MappedDictionary dictionary;
+    };
+
+    /// Write the columns to [[path]]. [[symbol_ids]] are ids of [[SymbolDictionary::shared()]].
+    void write(std::string_view path,
+               const std::vector<uint64_t>& timestamps,
+               const std::vector<SymbolId>& symbol_ids,
+               const std::vector<uint64_t>& values);
+
+    void write_prices(std::string_view path, const Prices& prices);
+    void write_order_book(std::string_view path, const OrderBook& order_book);
+
+    /// Load a columnar file into a relation. Only the symbols of the file dictionary are encoded with
+    /// [[SymbolDictionary::shared()]], the id column is remapped. Throws on ids outside the dictionary.
+    Prices load_prices(std::string_view path);
+    OrderBook load_order_book(std::string_view path);
+} // namespace columnar
+
+#endif // ASOF_JOIN_COLUMNAR_FILE_HPP
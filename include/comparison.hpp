@@ -0,0 +1,328 @@
+#ifndef ASOF_JOIN_COMPARISON_HPP
+#define ASOF_JOIN_COMPARISON_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "asof_join.hpp"
+#include "searches.hpp"
+#include "symbol_dictionary.hpp"
+
+/// Compile time semantics of a [[Comparison]] between the timestamp of a price (key) and
+/// the timestamp of an order (target), e.g. LESS_EQUAL_THAN matches the latest price with
+/// price.timestamp <= order.timestamp and GREATER_THAN the earliest price with price.timestamp > order.timestamp.
+///
+/// Of several prices with the matched timestamp, [[LAST_TIE]] comparisons match the last one in bin order
+/// (i.e. the highest price row), all others the first one. All kernels follow this rule, such that they
+/// produce the same rows.
+template<Comparison comp>
+struct ComparisonTraits;
+
+template<>
+struct ComparisonTraits<LESS_EQUAL_THAN> {
+    /// Comparison if the roles of key and target are swapped.
+    static constexpr Comparison MIRRORED = GREATER_EQUAL_THEN;
+    /// Whether the match lies before the target, i.e. the last matching key is the closest one.
+    static constexpr bool BACKWARD = true;
+    static constexpr bool LAST_TIE = true;
+
+    [[gnu::always_inline]] static inline bool matches(uint64_t key, uint64_t target) {
+        return key <= target;
+    }
+
+    /// Distance of a matching [[key]] to [[target]].
+    [[gnu::always_inline]] static inline uint64_t lag(uint64_t key, uint64_t target) {
+        return target - key;
+    }
+
+    /// Find the closest entry of the sorted [[data]] which matches [[target]].
+    template <typename T>
+    [[gnu::always_inline]] static inline T* search(std::vector<T>& data, uint64_t target) {
+        return Search::Interpolation::less_equal_than(data, target);
+    }
+};
+
+template<>
+struct ComparisonTraits<LESS_THAN> {
+    static constexpr Comparison MIRRORED = GREATER_THAN;
+    static constexpr bool BACKWARD = true;
+    static constexpr bool LAST_TIE = true;
+
+    [[gnu::always_inline]] static inline bool matches(uint64_t key, uint64_t target) {
+        return key < target;
+    }
+
+    [[gnu::always_inline]] static inline uint64_t lag(uint64_t key, uint64_t target) {
+        return target - key;
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static inline T* search(std::vector<T>& data, uint64_t target) {
+        return target == 0 ? nullptr : Search::Interpolation::less_equal_than(data, target - 1);
+    }
+};
+
+template<>
+struct ComparisonTraits<GREATER_EQUAL_THEN> {
+    static constexpr Comparison MIRRORED = LESS_EQUAL_THAN;
+    static constexpr bool BACKWARD = false;
+    static constexpr bool LAST_TIE = false;
+
+    [[gnu::always_inline]] static inline bool matches(uint64_t key, uint64_t target) {
+        return key >= target;
+    }
+
+    [[gnu::always_inline]] static inline uint64_t lag(uint64_t key, uint64_t target) {
+        return key - target;
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static inline T* search(std::vector<T>& data, uint64_t target) {
+        return Search::Interpolation::greater_equal_than(data, target);
+    }
+};
+
+template<>
+struct ComparisonTraits<GREATER_THAN> {
+    static constexpr Comparison MIRRORED = LESS_THAN;
+    static constexpr bool BACKWARD = false;
+    static constexpr bool LAST_TIE = false;
+
+    [[gnu::always_inline]] static inline bool matches(uint64_t key, uint64_t target) {
+        return key > target;
+    }
+
+    [[gnu::always_inline]] static inline uint64_t lag(uint64_t key, uint64_t target) {
+        return key - target;
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static inline T* search(std::vector<T>& data, uint64_t target) {
+        return target == UINT64_MAX ? nullptr : Search::Interpolation::greater_equal_than(data, target + 1);
+    }
+};
+
+template<>
+struct ComparisonTraits<EQUAL> {
+    static constexpr Comparison MIRRORED = EQUAL;
+    /// Merged like a forward looking comparison, i.e. keys smaller than the target are skipped,
+    /// but the last of several equal keys is matched like for LESS_EQUAL_THAN.
+    static constexpr bool BACKWARD = false;
+    static constexpr bool LAST_TIE = true;
+
+    [[gnu::always_inline]] static inline bool matches(uint64_t key, uint64_t target) {
+        return key == target;
+    }
+
+    [[gnu::always_inline]] static inline uint64_t lag(uint64_t key, uint64_t target) {
+        return key - target;
+    }
+
+    template <typename T>
+    [[gnu::always_inline]] static inline T* search(std::vector<T>& data, uint64_t target) {
+        auto* match = Search::Interpolation::less_equal_than(data, target);
+        return (match != nullptr && match->get_key() == target) ? match : nullptr;
+    }
+};
+
+template<>
+struct ComparisonTraits<NEAREST> {
+    static constexpr Comparison MIRRORED = NEAREST;
+    /// The last key before the target is the anchor, which is compared to its successor.
+    static constexpr bool BACKWARD = true;
+    static constexpr bool LAST_TIE = true;
+
+    [[gnu::always_inline]] static inline bool matches(uint64_t key, uint64_t target) {
+        return true;
+    }
+
+    [[gnu::always_inline]] static inline uint64_t lag(uint64_t key, uint64_t target) {
+        return key > target ? key - target : target - key;
+    }
+
+    /// Single search for the last key <= target, followed by a comparison with its successor.
+    /// On equal distance the earlier key is preferred.
+    template <typename T>
+    [[gnu::always_inline]] static inline T* search(std::vector<T>& data, uint64_t target) {
+        if (data.empty()) {
+            return nullptr;
+        }
+
+        T* before = Search::Interpolation::less_equal_than(data, target);
+        T* after = before == nullptr ? data.data() : before + 1;
+        if (after == data.data() + data.size()) {
+            return before;
+        }
+        if (before == nullptr) {
+            return after;
+        }
+        return after->get_key() - target < target - before->get_key() ? after : before;
+    }
+};
+
+/// Whether a sorted bin with keys in [min_key, max_key] may contain a match of [[target]]
+/// within [[max_lag]], i.e. whether it has to be searched at all.
+[[gnu::always_inline]] inline bool may_match_within(uint64_t min_key, uint64_t max_key,
+                                                    uint64_t target, uint64_t max_lag) {
+    uint64_t lower = target > max_lag ? target - max_lag : 0;
+    uint64_t upper = target > UINT64_MAX - max_lag ? UINT64_MAX : target + max_lag;
+    return max_key >= lower && min_key <= upper;
+}
+
+/// Find the same match as [[ComparisonTraits<comp>::search]] with a galloping search from [[cursor]].
+/// Targets of a bin have to be searched in ascending order with the same [[cursor]], starting at 0,
+/// such that each search continues where the previous one stopped.
+template<Comparison comp, typename T>
+[[gnu::always_inline]] inline T* merge_search(std::vector<T>& data, size_t& cursor, uint64_t target) {
+    cursor = Search::Galloping::lower_bound(data, cursor, target);
+    if constexpr (comp == LESS_THAN) {
+        return cursor > 0 ? &data[cursor - 1] : nullptr;
+    } else if constexpr (comp == GREATER_EQUAL_THEN) {
+        return cursor < data.size() ? &data[cursor] : nullptr;
+    } else {
+        size_t upper = Search::Galloping::upper_bound(data, cursor, target);
+        if constexpr (comp == LESS_EQUAL_THAN) {
+            return upper > 0 ? &data[upper - 1] : nullptr;
+        } else if constexpr (comp == GREATER_THAN) {
+            return upper < data.size() ? &data[upper] : nullptr;
+        } else if constexpr (comp == EQUAL) {
+            return upper > cursor ? &data[upper - 1] : nullptr;
+        } else {
+            T* before = upper > 0 ? &data[upper - 1] : nullptr;
+            T* after = upper < data.size() ? &data[upper] : nullptr;
+            if (before == nullptr || after == nullptr) {
+                return before == nullptr ? after : before;
+            }
+            return after->get_key() - target < target - before->get_key() ? after : before;
+        }
+    }
+}
+
+/// Find the same match as [[ComparisonTraits<comp>::search]] on a search [[layout]] of [[data]], i.e. a
+/// [[Search::Eytzinger::Layout]] or [[Search::KAry::Layout]]. The searches of the layout's namespace are found by ADL.
+template<Comparison comp, typename T, typename Layout>
+[[gnu::always_inline]] inline T* layout_search(std::vector<T>& data, const Layout& layout, uint64_t target) {
+    if constexpr (comp == LESS_EQUAL_THAN) {
+        return less_equal_than(data, layout, target);
+    } else if constexpr (comp == LESS_THAN) {
+        return target == 0 ? nullptr : less_equal_than(data, layout, target - 1);
+    } else if constexpr (comp == GREATER_EQUAL_THEN) {
+        return greater_equal_than(data, layout, target);
+    } else if constexpr (comp == GREATER_THAN) {
+        return target == UINT64_MAX ? nullptr : greater_equal_than(data, layout, target + 1);
+    } else if constexpr (comp == EQUAL) {
+        auto* match = less_equal_than(data, layout, target);
+        return (match != nullptr && match->get_key() == target) ? match : nullptr;
+    } else {
+        if (data.empty()) {
+            return nullptr;
+        }
+        T* before = less_equal_than(data, layout, target);
+        T* after = before == nullptr ? data.data() : before + 1;
+        if (after == data.data() + data.size()) {
+            return before;
+        }
+        if (before == nullptr) {
+            return after;
+        }
+        return after->get_key() - target < target - before->get_key() ? after : before;
+    }
+}
+
+/// Find the matches of [[ComparisonTraits<comp>::search]] for [[count]] lookups of [[targets[i]]] in
+/// [[*bins[i]]] at once with [[Search::Interleaved]]. Null bins have no match. Overwrites [[bins]] and [[targets]].
+template<Comparison comp, typename T>
+inline void interleaved_search(std::vector<T>** bins, uint64_t* targets, size_t count, T** results) {
+    /// Strict comparisons search the adjacent target, which does not exist at the bounds of the domain.
+    if constexpr (comp == LESS_THAN || comp == GREATER_THAN) {
+        for (size_t i = 0; i < count; ++i) {
+            if (targets[i] == (comp == LESS_THAN ? 0 : UINT64_MAX)) {
+                bins[i] = nullptr;
+            } else {
+                targets[i] = comp == LESS_THAN ? targets[i] - 1 : targets[i] + 1;
+            }
+        }
+    }
+
+    if constexpr (comp == GREATER_EQUAL_THEN || comp == GREATER_THAN) {
+        Search::Interleaved::greater_equal_than(bins, targets, count, results);
+    } else {
+        Search::Interleaved::less_equal_than(bins, targets, count, results);
+    }
+
+    if constexpr (comp == EQUAL) {
+        for (size_t i = 0; i < count; ++i) {
+            if (results[i] != nullptr && results[i]->get_key() != targets[i]) {
+                results[i] = nullptr;
+            }
+        }
+    } else if constexpr (comp == NEAREST) {
+        for (size_t i = 0; i < count; ++i) {
+            if (bins[i] == nullptr || bins[i]->empty()) {
+                continue;
+            }
+            T* before = results[i];
+            T* after = before == nullptr ? bins[i]->data() : before + 1;
+            if (after == bins[i]->data() + bins[i]->size()) {
+                continue;
+            }
+            if (before == nullptr || after->get_key() - targets[i] < targets[i] - before->get_key()) {
+                results[i] = after;
+            }
+        }
+    }
+}
+
+/// Row of a probe morsel, see [[sort_probes]].
+struct BatchProbe {
+    SymbolId symbol_id;
+    uint64_t timestamp;
+    size_t idx;
+};
+
+/// Rows [begin, end) of a probe relation grouped by their stock and sorted by their timestamp, such that
+/// all probes into a bin can be resolved with [[merge_search]] in one pass over the bin.
+inline std::vector<BatchProbe> sort_probes(const std::vector<SymbolId>& symbol_ids,
+                                           const std::vector<uint64_t>& timestamps, size_t begin, size_t end) {
+    std::vector<BatchProbe> probes;
+    probes.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+        probes.push_back({symbol_ids[i], timestamps[i], i});
+    }
+    std::sort(probes.begin(), probes.end(), [](const BatchProbe& lhs, const BatchProbe& rhs) {
+        return lhs.symbol_id != rhs.symbol_id ? lhs.symbol_id < rhs.symbol_id : lhs.timestamp < rhs.timestamp;
+    });
+    return probes;
+}
+
+/// Call [[func]] with [[comp]] as template argument, such that a join kernel is instantiated
+/// once per comparison and carries no branch on the comparison per row.
+template<typename Func>
+inline void with_comparison(Comparison comp, Func&& func) {
+    switch (comp) {
+        case LESS_THAN:
+            func.template operator()<LESS_THAN>();
+            break;
+        case LESS_EQUAL_THAN:
+            func.template operator()<LESS_EQUAL_THAN>();
+            break;
+        case EQUAL:
+            func.template operator()<EQUAL>();
+            break;
+        case GREATER_THAN:
+            func.template operator()<GREATER_THAN>();
+            break;
+        case GREATER_EQUAL_THEN:
+            func.template operator()<GREATER_EQUAL_THEN>();
+            break;
+        case NEAREST:
+            func.template operator()<NEAREST>();
+            break;
+        default:
+            throw std::invalid_argument("Unknown comparison");
+    }
+}
+
+#endif // ASOF_JOIN_COMPARISON_HPP
@@ -0,0 +1,42 @@
+#ifndef ASOF_JOIN_CSV_PARSER_HPP
+#define ASOF_JOIN_CSV_PARSER_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Parser for our csv format "timestamp,stock_id,value\n".
+namespace csv {
+    /// Columns of the rows parsed from a range of a csv file.
+    struct Columns {
+        std::vector<uint64_t> timestamps;
+        std::vector<std::string> stock_ids;
+        std::vector<uint64_t> values;
+    };
+
+    /// Parse [[field]] with [[std::from_chars]]. Throws if it is not a valid number.
+    uint64_t string_view_to_uint64_t(std::string_view field);
+
+    /// Parse all rows in [[begin, end)]. [[begin]] must point to the start of a row.
+    /// [[buffer_begin]] is the start of the whole mapped buffer. The SIMD number parsing may
+    /// read (but ignores) bytes in [[buffer_begin, begin)]] in front of a field.
+    /// If [[is_first_range]] is set, a leading header row is skipped.
+    void parse_rows(const char* buffer_begin, const char* begin, const char* end,
+                    char delimiter, bool is_first_range, Columns& columns);
+
+    void parse_rows_scalar(const char* begin, const char* end,
+                           char delimiter, bool is_first_range, Columns& columns);
+
+    void parse_rows_avx2(const char* buffer_begin, const char* begin, const char* end,
+                         char delimiter, bool is_first_range, Columns& columns);
+
+    /// Parse a number with at most 19 digits with SSE. Falls back to
+    /// [[string_view_to_uint64_t]] if the field is longer or contains non-digits.
+    uint64_t parse_uint64_simd(const char* buffer_begin, std::string_view field);
+
+    /// Checked once at runtime.
+    bool avx2_supported();
+} // namespace csv
+
+#endif // ASOF_JOIN_CSV_PARSER_HPP
@@ -14,14 +14,30 @@ class MemoryMappedFile {
 
 public:
     explicit MemoryMappedFile(std::string_view path) {
-        handle = ::open(path.begin(), O_RDONLY);
+        handle = ::open(std::string(path).c_str(), O_RDONLY);
+        if (handle < 0) {
+            throw std::runtime_error("Failed to open " + std::string(path));
+        }
         lseek(handle, 0, SEEK_END);
         size = lseek(handle, 0, SEEK_CUR);
+        if (size == 0) {
+            mapping = nullptr;
+            return;
+        }
         mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, handle, 0);
+        if (mapping == MAP_FAILED) {
+            close(handle);
+            throw std::runtime_error("Failed to mmap " + std::string(path));
+        }
     }
 
+    MemoryMappedFile(const MemoryMappedFile& other) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile& other) = delete;
+
     ~MemoryMappedFile() {
-        munmap(mapping, size);
+        if (mapping) {
+            munmap(mapping, size);
+        }
         close(handle);
     }
 
@@ -33,9 +49,61 @@ public:
         return static_cast<char*>(mapping) + size;
     }
 
+    [[nodiscard]] size_t file_size() const {
+        return size;
+    }
+
+    /// Whether [[count]] elements of [[element_size]] bytes at [[offset]] lie within the file,
+    /// checked without overflow for corrupt headers.
+    [[nodiscard]] bool fits(uint64_t offset, uint64_t count, size_t element_size) const {
+        return offset <= size && count <= (size - offset) / element_size;
+    }
+
 private:
     int handle;
     void* mapping;
 };
 
+/// Symbol dictionary stored in a mapped file as uint64_t[num_symbols + 1] string offsets,
+/// followed by the symbol bytes.
+class MappedDictionary {
+public:
+    MappedDictionary() = default;
+
+    /// Throws unless the dictionary at [[offset]] lies within [[file]] and its offsets do not decrease,
+    /// such that every [[symbol]] is a view into the file. [[description]] names the file in errors.
+    MappedDictionary(const MemoryMappedFile& file, uint64_t offset, uint64_t num_symbols,
+                     const std::string& description): num_symbols(num_symbols) {
+        if (offset % alignof(uint64_t) != 0 || num_symbols == SIZE_MAX ||
+                !file.fits(offset, num_symbols + 1, sizeof(uint64_t))) {
+            throw std::runtime_error("Truncated dictionary in " + description);
+        }
+
+        offsets = reinterpret_cast<const uint64_t*>(file.begin() + offset);
+        bytes = reinterpret_cast<const char*>(offsets + num_symbols + 1);
+        if (offsets[num_symbols] > static_cast<size_t>(file.end() - bytes)) {
+            throw std::runtime_error("Truncated dictionary in " + description);
+        }
+        for (size_t id = 0; id < num_symbols; ++id) {
+            if (offsets[id] > offsets[id + 1]) {
+                throw std::runtime_error("Invalid dictionary in " + description);
+            }
+        }
+    }
+
+    [[nodiscard]] size_t size() const {
+        return num_symbols;
+    }
+
+    /// [[id]] has to be smaller than [[size()]].
+    [[nodiscard]] std::string_view symbol(size_t id) const {
+        return {bytes + offsets[id], offsets[id + 1] - offsets[id]};
+    }
+
+private:
+    size_t num_symbols = 0;
+    const uint64_t* offsets = nullptr;
+    const char* bytes = nullptr;
+};
+
 #endif //ASOF_JOIN_MMAP_FILE_HPP
@@ -1,6 +1,10 @@
 #ifndef ASOF_JOIN_PARALLEL_MULTI_MAP_HPP
 #define ASOF_JOIN_PARALLEL_MULTI_MAP_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
 #include <vector>
 #include <iostream>
 
@@ -8,16 +12,27 @@
 #include "tbb/parallel_invoke.h"
 #include "tbb/parallel_for.h"
 #include "tbb/parallel_for_each.h"
+#include "tbb/parallel_reduce.h"
+#include "tbb/task_arena.h"
 
+#include "radix_partition.hpp"
+#include "radix_sort.hpp"
+#include "searches.hpp"
 #include "tuple_buffer.hpp"
+#include "symbol_dictionary.hpp"
 
 
-template<typename Entry>
+/// String keys are stored and looked up as views into the (caller owned) key column,
+/// integral keys such as [[SymbolId]] are stored by value.
+template<typename Key>
+using MultiMapKey = std::conditional_t<std::is_same_v<Key, std::string>, std::string_view, Key>;
+
+
+template<typename Entry, typename Key = std::string>
 class MultiMap {
 public:
-    using Key = std::string;
     using Value = uint64_t;
-    using MapKey = std::string_view;
+    using MapKey = MultiMapKey<Key>;
     using iterator = std::unordered_map<MapKey, std::vector<Entry>>::iterator;
 
     MultiMap(const std::vector<Key>& equality_keys, const std::vector<Value>& sort_by_keys,
@@ -83,7 +98,7 @@ private:
 
     struct Partitions {
         explicit Partitions(size_t num_partitions): partitions(num_partitions) {}
-        std::vector<std::vector<std::pair<Key, Entry>>> partitions;
+        std::vector<std::vector<std::pair<MapKey, Entry>>> partitions;
     };
 
     const std::vector<Key>& equality_keys;
@@ -91,7 +106,7 @@ private:
     const size_t num_partitions;
     const uint64_t mask;
 
-    std::hash<Key> hash;
+    std::hash<MapKey> hash;
 
     tbb::enumerable_thread_specific<Partitions> thread_data;
     tbb::enumerable_thread_specific<std::unordered_map<MapKey, std::vector<Entry>>> local_maps;
@@ -100,12 +115,11 @@ private:
 };
 
 
-template<typename Entry>
+template<typename Entry, typename Key = std::string>
 class MultiMapTB {
 public:
-    using Key = std::string;
     using Value = uint64_t;
-    using MapKey = std::string_view;
+    using MapKey = MultiMapKey<Key>;
 
     /// Forward Declaration.
     class Iterator;
@@ -277,7 +291,7 @@ private:
     struct Partitions {
         Partitions(): partitions(0) {}
         explicit Partitions(unsigned num_partitions): partitions(num_partitions) {}
-        std::vector<TupleBuffer<std::pair<Key, Entry>>> partitions;
+        std::vector<TupleBuffer<std::pair<MapKey, Entry>>> partitions;
     };
 
     const std::vector<Key>& equality_keys;
@@ -293,8 +307,8 @@ private:
     //PerfEvent e;
 };
 
-template<typename Entry>
-class MultiMapTB<Entry>::Iterator {
+template<typename Entry, typename Key>
+class MultiMapTB<Entry, Key>::Iterator {
 public:
     /// Use the unordered_map iterator type as the base iterator for value, etc.
     using base_iterator = typename std::unordered_map<MapKey, std::vector<Entry>>::iterator;
@@ -363,4 +377,491 @@ private:
     base_iterator current_iter;
 };
 
+
+/// [[MultiMapTB]] mode for dense integer keys, i.e. [[SymbolId]]s from the [[SymbolDictionary]].
+/// Instead of hashing the keys into partitions with an [[std::unordered_map]] per partition,
+/// the bins are directly addressed by their id in a flat array, which turns [[find()]] into a
+/// single array lookup.
+template<typename Entry>
+class MultiMapTB<Entry, SymbolId> {
+public:
+    using Key = SymbolId;
+    using Value = uint64_t;
+    using MapKey = SymbolId;
+    using Bin = std::pair<MapKey, std::vector<Entry>>;
+
+    /// Forward Declaration.
+    class Iterator;
+
+    MultiMapTB(const std::vector<Key>& equality_keys, const std::vector<Value>& sort_by_keys,
+             unsigned num_partitions = 1024): equality_keys(equality_keys),
+             sort_by_keys(sort_by_keys), num_partitions(num_partitions),
+             num_keys(0) {
+        partition();
+    }
+
+    MultiMapTB(const MultiMapTB& other):
+        equality_keys(other.equality_keys),
+        sort_by_keys(other.sort_by_keys),
+        num_partitions(other.num_partitions),
+        bins(other.bins),
+        bin_runs(other.bin_runs),
+        eytzinger_layouts(other.eytzinger_layouts),
+        kary_layouts(other.kary_layouts),
+        learned_layouts(other.learned_layouts),
+        num_keys(other.num_keys) {}
+
+    ~MultiMapTB() {
+        tbb::parallel_for_each(bins.begin(), bins.end(),
+            [&](auto& bin) {
+            bin.second.clear();
+        });
+
+        bins.clear();
+    }
+
+    [[nodiscard]] inline Iterator begin() {
+        return Iterator(this, /* bin_idx= */ 0);
+    }
+
+    [[nodiscard]] inline Iterator end() {
+        return Iterator(this, bins.size());
+    }
+
+    [[nodiscard]] inline bool contains(MapKey key) const {
+        return key < bins.size() && !bins[key].second.empty();
+    }
+
+    [[nodiscard]] inline std::vector<Entry>* find(MapKey key) {
+        return contains(key) ? &bins[key].second : nullptr;
+    }
+
+    /// Number of keys with at least one entry.
+    [[nodiscard]] inline size_t size() const {
+        return num_keys;
+    }
+
+    /// [[key]] has to be part of the [[equality_keys]].
+    [[nodiscard]] [[gnu::always_inline]] std::vector<Entry>& operator[](MapKey key) {
+        return bins[key].second;
+    }
+
+    /// Contiguous range [begin, end) of the entries of the bin of [[key]].
+    struct BinRange {
+        MapKey key;
+        size_t begin;
+        size_t end;
+    };
+
+    /// Bins are only split into ranges of at least this size.
+    static constexpr size_t MIN_RANGE_SIZE = 1 << 15;
+    /// Target number of ranges per thread, such that heavy bins keep all threads busy.
+    static constexpr size_t RANGES_PER_THREAD = 4;
+    /// Bins of at most this many ascending runs are merged instead of sorted.
+    static constexpr size_t MAX_MERGE_RUNS = 64;
+
+    /// Sort every bin by its sort key and return all bins as ranges, see [[sort_bins(max_range_size)]].
+    std::vector<BinRange> sort_bins() {
+        const size_t num_threads = static_cast<size_t>(tbb::this_task_arena::max_concurrency());
+        return sort_bins(std::max(MIN_RANGE_SIZE, equality_keys.size() / (RANGES_PER_THREAD * num_threads)));
+    }
+
+    /// Sort every bin by its sort key and return all bins as ranges.
+    /// Skewed bins with more than [[max_range_size]] entries are range partitioned by their sort key
+    /// into multiple ranges first. Every range is sorted independently, after which the whole bin is
+    /// sorted, and can be processed as an independent task by the join phases.
+    /// Bins which were already built in order, e.g. from time ordered input, are not touched, and bins
+    /// of only a few ascending runs are merged, see [[sort_range]].
+    std::vector<BinRange> sort_bins(size_t max_range_size) {
+        std::vector<BinRange> ranges;
+        std::vector<MapKey> heavy_keys;
+        for (auto& [key, bin] : bins) {
+            if (bin.size() > max_range_size) {
+                heavy_keys.push_back(key);
+            } else if (!bin.empty()) {
+                ranges.push_back({key, 0, bin.size()});
+            }
+        }
+
+        for (auto key : heavy_keys) {
+            size_t num_ranges = (bins[key].second.size() + max_range_size - 1) / max_range_size;
+            if (bin_runs[key] == 1) {
+                split_sorted_bin(key, num_ranges, ranges);
+            } else {
+                split_bin(key, num_ranges, ranges);
+            }
+        }
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, ranges.size(), 1),
+                [&](tbb::blocked_range<size_t>& local_range) {
+            for (size_t i = local_range.begin(); i < local_range.end(); ++i) {
+                sort_range(ranges[i]);
+            }
+        });
+        return ranges;
+    }
+
+    /// Bins with fewer entries fit into the caches, so their search gains nothing from a search layout.
+    static constexpr size_t MIN_LAYOUT_BIN_SIZE = 1 << 16;
+
+    /// Build the Eytzinger layout of every sorted bin with at least [[min_bin_size]] entries,
+    /// see [[Search::Eytzinger]]. Has to be called after [[sort_bins]] and rebuilt if the bins change.
+    void build_eytzinger_layouts(size_t min_bin_size = MIN_LAYOUT_BIN_SIZE) {
+        build_layouts(eytzinger_layouts, min_bin_size);
+    }
+
+    /// Build the k-ary search tree of every sorted bin with at least [[min_bin_size]] entries,
+    /// see [[Search::KAry]]. Has to be called after [[sort_bins]] and rebuilt if the bins change.
+    void build_kary_layouts(size_t min_bin_size = MIN_LAYOUT_BIN_SIZE) {
+        build_layouts(kary_layouts, min_bin_size);
+    }
+
+    /// Build the learned index of every sorted bin with at least [[min_bin_size]] entries,
+    /// see [[Search::Learned]]. Has to be called after [[sort_bins]] and rebuilt if the bins change.
+    void build_learned_layouts(size_t min_bin_size = MIN_LAYOUT_BIN_SIZE) {
+        build_layouts(learned_layouts, min_bin_size);
+    }
+
+    /// Eytzinger layout of the bin of [[key]], or null if it has none.
+    [[nodiscard]] inline const Search::Eytzinger::Layout* eytzinger_layout(MapKey key) const {
+        return find_layout(eytzinger_layouts, key);
+    }
+
+    /// K-ary search tree of the bin of [[key]], or null if it has none.
+    [[nodiscard]] inline const Search::KAry::Layout* kary_layout(MapKey key) const {
+        return find_layout(kary_layouts, key);
+    }
+
+    /// Learned index of the bin of [[key]], or null if it has none.
+    [[nodiscard]] inline const Search::Learned::Layout* learned_layout(MapKey key) const {
+        return find_layout(learned_layouts, key);
+    }
+
+    [[nodiscard]] size_t total_size_bytes() const {
+        size_t total_size = sizeof(MultiMapTB);
+        total_size += bins.size() * sizeof(Bin);
+        for (auto& [_, bin] : bins) {
+            total_size += bin.size() * sizeof(Entry);
+        }
+        return total_size;
+    }
+
+private:
+    /// Radix partition the rows by their key, see [[radix::partition]].
+    /// If all keys fit into [[num_partitions]] partitions, a single pass scatters every key into its own
+    /// partition. Otherwise the first pass partitions by the upper bits of the key, such that the written
+    /// partitions stay within the TLB and write-combining capacity, and the second pass splits every
+    /// partition by the lower bits directly into the bins while the partition is cache resident.
+    void partition() {
+        if (equality_keys.empty()) {
+            return;
+        }
+
+        MapKey max_key = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, equality_keys.size()), MapKey{0},
+            [&](const tbb::blocked_range<size_t>& range, MapKey local_max) {
+                for (size_t i = range.begin(); i < range.end(); ++i) {
+                    local_max = std::max(local_max, equality_keys[i]);
+                }
+                return local_max;
+            },
+            [](MapKey lhs, MapKey rhs) { return std::max(lhs, rhs); });
+
+        const size_t num_bins = static_cast<size_t>(max_key) + 1;
+        const unsigned partition_bits = std::bit_width(std::max(num_partitions, 1u)) - 1;
+        const unsigned key_bits = std::bit_width(static_cast<size_t>(max_key));
+        const unsigned shift = num_bins <= num_partitions ? 0 : key_bits - partition_bits;
+        const size_t fanout = (static_cast<size_t>(max_key) >> shift) + 1;
+
+        auto partitioned = radix::partition(equality_keys, sort_by_keys, shift, fanout);
+        const auto& tuples = partitioned.tuples;
+        const auto& offsets = partitioned.partition_offsets;
+
+        bins.resize(num_bins);
+        bin_runs.assign(num_bins, 0);
+        std::atomic<size_t> total_keys = 0;
+
+        /// Each key belongs to exactly one partition, so partitions can fill their bins independently.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, fanout), [&](tbb::blocked_range<size_t>& range) {
+            size_t local_keys = 0;
+            std::vector<size_t> counts;
+            std::vector<uint64_t> last_values;
+            for (size_t p = range.begin(); p < range.end(); ++p) {
+                /// The keys of partition [[p]] are [p << shift, (p + 1) << shift).
+                const size_t first_key = p << shift;
+                const size_t last_key = std::min(num_bins, (p + 1) << shift);
+
+                /// Count first to allocate every bin exactly once. The partitioning is stable, so the
+                /// entries of a bin arrive in row order and the ascending runs are counted on the way.
+                counts.assign(last_key - first_key, 0);
+                last_values.resize(last_key - first_key);
+                for (size_t i = offsets[p]; i < offsets[p + 1]; ++i) {
+                    const auto& tuple = tuples[i];
+                    size_t key = equality_keys[tuple.idx];
+                    if (counts[key - first_key]++ == 0 || tuple.value < last_values[key - first_key]) {
+                        ++bin_runs[key];
+                    }
+                    last_values[key - first_key] = tuple.value;
+                }
+
+                for (size_t key = first_key; key < last_key; ++key) {
+                    bins[key].first = static_cast<MapKey>(key);
+                    bins[key].second.reserve(counts[key - first_key]);
+                    local_keys += counts[key - first_key] != 0;
+                }
+
+                for (size_t i = offsets[p]; i < offsets[p + 1]; ++i) {
+                    const auto& tuple = tuples[i];
+                    bins[equality_keys[tuple.idx]].second.emplace_back(tuple.value, tuple.idx);
+                }
+            }
+            total_keys += local_keys;
+        });
+
+        num_keys = total_keys;
+    }
+
+    template<typename Layout>
+    void build_layouts(std::vector<Layout>& layouts, size_t min_bin_size) {
+        layouts.clear();
+        layouts.resize(bins.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, bins.size(), 1),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t key = range.begin(); key < range.end(); ++key) {
+                if (bins[key].second.size() >= min_bin_size) {
+                    layouts[key] = Layout(bins[key].second);
+                }
+            }
+        });
+    }
+
+    template<typename Layout>
+    [[nodiscard]] static inline const Layout* find_layout(const std::vector<Layout>& layouts, MapKey key) {
+        return key < layouts.size() && layouts[key].size() > 0 ? &layouts[key] : nullptr;
+    }
+
+    /// Sort the entries of [[range]]. Ranges spanning a whole bin use the runs counted while building the
+    /// bin, split ranges count their runs first. A single run is already sorted, up to [[MAX_MERGE_RUNS]]
+    /// runs are merged with a k-way merge, and everything else is radix sorted.
+    void sort_range(const BinRange& range) {
+        auto& bin = bins[range.key].second;
+        auto first = bin.begin() + range.begin;
+        auto last = bin.begin() + range.end;
+
+        size_t num_runs = range.begin == 0 && range.end == bin.size()
+            ? bin_runs[range.key]
+            : 1 + count_descents(first, last);
+        if (num_runs <= 1) {
+            return;
+        }
+        if (num_runs > MAX_MERGE_RUNS) {
+            radix::sort(first, last);
+            return;
+        }
+
+        std::vector<size_t> run_begins{0};
+        for (size_t i = 1; i < range.end - range.begin; ++i) {
+            if (first[i].get_key() < first[i - 1].get_key()) {
+                run_begins.push_back(i);
+            }
+        }
+        run_begins.push_back(range.end - range.begin);
+        merge_runs(first, run_begins);
+    }
+
+    template<typename Iterator>
+    static size_t count_descents(Iterator first, Iterator last) {
+        size_t num_descents = 0;
+        for (auto it = first + 1; it < last; ++it) {
+            num_descents += it->get_key() < (it - 1)->get_key();
+        }
+        return num_descents;
+    }
+
+    /// K-way merge of the ascending runs [run_begins[j], run_begins[j + 1]) starting at [[first]].
+    /// Ties are taken from the earlier run, such that equal keys keep their order.
+    template<typename Iterator>
+    static void merge_runs(Iterator first, const std::vector<size_t>& run_begins) {
+        const size_t num_runs = run_begins.size() - 1;
+        std::vector<size_t> positions(run_begins.begin(), run_begins.end() - 1);
+
+        using HeapEntry = std::pair<uint64_t, size_t>;
+        std::vector<HeapEntry> heap;
+        heap.reserve(num_runs);
+        for (size_t j = 0; j < num_runs; ++j) {
+            heap.emplace_back(first[positions[j]].get_key(), j);
+        }
+        auto greater = std::greater<HeapEntry>();
+        std::make_heap(heap.begin(), heap.end(), greater);
+
+        std::vector<Entry> merged;
+        merged.reserve(run_begins.back());
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            size_t run = heap.back().second;
+            merged.push_back(std::move(first[positions[run]++]));
+            if (positions[run] < run_begins[run + 1]) {
+                heap.back().first = first[positions[run]].get_key();
+                std::push_heap(heap.begin(), heap.end(), greater);
+            } else {
+                heap.pop_back();
+            }
+        }
+        std::move(merged.begin(), merged.end(), first);
+    }
+
+    /// Cut the already sorted bin of [[key]] into [[num_ranges]] ranges of about equal size and append
+    /// them to [[ranges]]. Cuts are moved behind runs of equal keys, like the splitters of [[split_bin]].
+    void split_sorted_bin(MapKey key, size_t num_ranges, std::vector<BinRange>& ranges) {
+        auto& bin = bins[key].second;
+        size_t begin = 0;
+        for (size_t j = 1; j <= num_ranges && begin < bin.size(); ++j) {
+            size_t end = j * bin.size() / num_ranges;
+            while (end > begin && end < bin.size() && bin[end].get_key() == bin[end - 1].get_key()) {
+                ++end;
+            }
+            if (end > begin) {
+                ranges.push_back({key, begin, end});
+                begin = end;
+            }
+        }
+    }
+
+    /// Range partition the bin of [[key]] by its sort key into [[num_ranges]] ranges with splitters
+    /// taken from a sample and append the non-empty ranges to [[ranges]].
+    void split_bin(MapKey key, size_t num_ranges, std::vector<BinRange>& ranges) {
+        static constexpr size_t SAMPLES_PER_RANGE = 32;
+        static constexpr size_t CHUNK_SIZE = 1 << 14;
+
+        auto& bin = bins[key].second;
+        const size_t sample_size = std::min(bin.size(), num_ranges * SAMPLES_PER_RANGE);
+        std::vector<uint64_t> sample(sample_size);
+        for (size_t i = 0; i < sample_size; ++i) {
+            sample[i] = bin[i * bin.size() / sample_size].get_key();
+        }
+        std::sort(sample.begin(), sample.end());
+
+        /// Equal keys always end up in the same range, so the concatenated sorted ranges are sorted.
+        std::vector<uint64_t> splitters(num_ranges - 1);
+        for (size_t j = 1; j < num_ranges; ++j) {
+            splitters[j - 1] = sample[j * sample_size / num_ranges];
+        }
+        auto range_of = [&](const Entry& entry) {
+            return static_cast<size_t>(
+                std::upper_bound(splitters.begin(), splitters.end(), entry.get_key()) - splitters.begin());
+        };
+
+        const size_t num_chunks = (bin.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        std::vector<size_t> offsets(num_chunks * num_ranges, 0);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+                [&](tbb::blocked_range<size_t>& local_range) {
+            for (size_t chunk = local_range.begin(); chunk < local_range.end(); ++chunk) {
+                size_t end = std::min(bin.size(), (chunk + 1) * CHUNK_SIZE);
+                for (size_t i = chunk * CHUNK_SIZE; i < end; ++i) {
+                    ++offsets[chunk * num_ranges + range_of(bin[i])];
+                }
+            }
+        });
+
+        /// Exclusive prefix sum in range major order, such that every chunk writes into its own slice of each range.
+        std::vector<size_t> range_begins(num_ranges + 1, 0);
+        size_t offset = 0;
+        for (size_t j = 0; j < num_ranges; ++j) {
+            range_begins[j] = offset;
+            for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+                size_t count = offsets[chunk * num_ranges + j];
+                offsets[chunk * num_ranges + j] = offset;
+                offset += count;
+            }
+        }
+        range_begins[num_ranges] = offset;
+
+        std::vector<Entry> partitioned(bin.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+                [&](tbb::blocked_range<size_t>& local_range) {
+            for (size_t chunk = local_range.begin(); chunk < local_range.end(); ++chunk) {
+                size_t end = std::min(bin.size(), (chunk + 1) * CHUNK_SIZE);
+                for (size_t i = chunk * CHUNK_SIZE; i < end; ++i) {
+                    partitioned[offsets[chunk * num_ranges + range_of(bin[i])]++] = bin[i];
+                }
+            }
+        });
+        bin.swap(partitioned);
+
+        for (size_t j = 0; j < num_ranges; ++j) {
+            if (range_begins[j] != range_begins[j + 1]) {
+                ranges.push_back({key, range_begins[j], range_begins[j + 1]});
+            }
+        }
+    }
+
+    const std::vector<Key>& equality_keys;
+    const std::vector<Value>& sort_by_keys;
+    const unsigned num_partitions;
+
+    /// Bin of key [[k]] is stored at [[bins[k]]], empty bins belong to keys without entries.
+    std::vector<Bin> bins;
+    /// Number of ascending runs of each bin as built by [[partition()]], 1 for sorted bins.
+    std::vector<uint32_t> bin_runs;
+    /// Key-only search shadows of large bins, see [[build_eytzinger_layouts]], [[build_kary_layouts]] and
+    /// [[build_learned_layouts]].
+    std::vector<Search::Eytzinger::Layout> eytzinger_layouts;
+    std::vector<Search::KAry::Layout> kary_layouts;
+    std::vector<Search::Learned::Layout> learned_layouts;
+    size_t num_keys;
+};
+
+template<typename Entry>
+class MultiMapTB<Entry, SymbolId>::Iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Bin;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Bin*;
+    using reference = Bin&;
+
+    Iterator(): parent(nullptr), bin_idx(0) {}
+
+    Iterator(MultiMapTB* parent, size_t bin_idx): parent(parent), bin_idx(bin_idx) {
+        skip_empty_bins();
+    }
+
+    Iterator& operator++() {
+        ++bin_idx;
+        skip_empty_bins();
+        return *this;
+    }
+
+    Iterator operator++(int) {
+        Iterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    reference operator*() const {
+        return parent->bins[bin_idx];
+    }
+
+    pointer operator->() const {
+        return &parent->bins[bin_idx];
+    }
+
+    bool operator==(const Iterator& other) const {
+        return parent == other.parent && bin_idx == other.bin_idx;
+    }
+
+    bool operator!=(const Iterator& other) const {
+        return !(*this == other);
+    }
+
+private:
+    void skip_empty_bins() {
+        while (bin_idx < parent->bins.size() && parent->bins[bin_idx].second.empty()) {
+            ++bin_idx;
+        }
+    }
+
+    MultiMapTB* parent;
+    size_t bin_idx;
+};
+
 #endif // ASOF_JOIN_PARALLEL_MULTI_MAP_HPP
@@ -0,0 +1,143 @@
+#ifndef ASOF_JOIN_RADIX_PARTITION_HPP
+#define ASOF_JOIN_RADIX_PARTITION_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+#include "symbol_dictionary.hpp"
+
+/// Radix partitioning of a relation by its dense [[SymbolId]] keys.
+///
+/// Rows are scattered as compact (value, idx) tuples instead of full join entries. A histogram pass
+/// sizes every partition exactly, and the scatter pass collects the tuples of each partition in a
+/// cache line sized software write-combining buffer, which is written with streaming stores once full.
+/// This keeps the number of written cache lines (and touched pages) per partition minimal, even for
+/// a large fan-out.
+namespace radix {
+    struct alignas(16) PartitionTuple {
+        uint64_t value;
+        uint64_t idx;
+    };
+
+    constexpr size_t CACHE_LINE_SIZE = 64;
+    constexpr size_t TUPLES_PER_LINE = CACHE_LINE_SIZE / sizeof(PartitionTuple);
+    /// Rows per task of the histogram and scatter pass.
+    constexpr size_t MIN_CHUNK_SIZE = 1 << 16;
+
+    /// Tuples of all rows ordered by their partition. Partition [[p]] is
+    /// [partition_offsets[p], partition_offsets[p + 1]).
+    struct Partitioned {
+        std::vector<PartitionTuple> tuples;
+        std::vector<size_t> partition_offsets;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) WriteCombiningLine {
+        PartitionTuple tuples[TUPLES_PER_LINE];
+    };
+
+    /// Write a full buffer to the cache line aligned [[dest]] bypassing the caches.
+    [[gnu::always_inline]] inline void stream_line(PartitionTuple* dest, const WriteCombiningLine& line) {
+#ifdef __x86_64__
+        const auto* src = reinterpret_cast<const __m128i*>(line.tuples);
+        auto* out = reinterpret_cast<__m128i*>(dest);
+        for (size_t i = 0; i < TUPLES_PER_LINE; ++i) {
+            _mm_stream_si128(out + i, _mm_load_si128(src + i));
+        }
+#else
+        std::memcpy(dest, line.tuples, sizeof(line.tuples));
+#endif
+    }
+
+    /// Scatter the rows into [[fanout]] partitions by [[keys[i] >> shift]].
+    /// [[fanout]] must be larger than the partition of every key.
+    inline Partitioned partition(const std::vector<SymbolId>& keys, const std::vector<uint64_t>& values,
+                                 unsigned shift, size_t fanout) {
+        const size_t num_rows = keys.size();
+        const size_t num_threads = static_cast<size_t>(tbb::this_task_arena::max_concurrency());
+        const size_t num_chunks = std::max<size_t>(1, std::min(num_rows / MIN_CHUNK_SIZE, 4 * num_threads));
+        auto chunk_begin = [&](size_t chunk) { return chunk * num_rows / num_chunks; };
+
+        /// Histogram pass, which gives every chunk its exact output region per partition.
+        std::vector<size_t> offsets(num_chunks * fanout, 0);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t chunk = range.begin(); chunk < range.end(); ++chunk) {
+                size_t* counts = offsets.data() + chunk * fanout;
+                for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+                    ++counts[keys[i] >> shift];
+                }
+            }
+        });
+
+        Partitioned result;
+        result.partition_offsets.resize(fanout + 1);
+        size_t offset = 0;
+        for (size_t p = 0; p < fanout; ++p) {
+            result.partition_offsets[p] = offset;
+            for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+                size_t count = offsets[chunk * fanout + p];
+                offsets[chunk * fanout + p] = offset;
+                offset += count;
+            }
+        }
+        result.partition_offsets[fanout] = offset;
+        result.tuples.resize(num_rows);
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+                [&](tbb::blocked_range<size_t>& range) {
+            std::vector<WriteCombiningLine> lines(fanout);
+            std::vector<uint8_t> fill(fanout);
+            /// Number of tuples after which the buffer of a partition is written.
+            std::vector<uint8_t> line_end(fanout);
+            PartitionTuple* out = result.tuples.data();
+
+            for (size_t chunk = range.begin(); chunk < range.end(); ++chunk) {
+                size_t* chunk_offsets = offsets.data() + chunk * fanout;
+                std::fill(fill.begin(), fill.end(), 0);
+                /// The regions of the chunks are not line aligned, so the first buffer of each only
+                /// fills up to the next cache line boundary of the output.
+                for (size_t p = 0; p < fanout; ++p) {
+                    auto address = reinterpret_cast<uintptr_t>(out + chunk_offsets[p]);
+                    line_end[p] = TUPLES_PER_LINE - address % CACHE_LINE_SIZE / sizeof(PartitionTuple);
+                }
+
+                for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+                    size_t p = keys[i] >> shift;
+                    lines[p].tuples[fill[p]++] = {values[i], i};
+                    if (fill[p] == line_end[p]) {
+                        /// Only whole, aligned lines are streamed, the head uses regular stores.
+                        if (fill[p] == TUPLES_PER_LINE) {
+                            stream_line(out + chunk_offsets[p], lines[p]);
+                        } else {
+                            std::copy_n(lines[p].tuples, fill[p], out + chunk_offsets[p]);
+                        }
+                        chunk_offsets[p] += fill[p];
+                        fill[p] = 0;
+                        line_end[p] = TUPLES_PER_LINE;
+                    }
+                }
+
+                /// Flush the partially filled buffers with regular stores.
+                for (size_t p = 0; p < fanout; ++p) {
+                    std::copy_n(lines[p].tuples, fill[p], out + chunk_offsets[p]);
+                }
+            }
+#ifdef __x86_64__
+            _mm_sfence();
+#endif
+        });
+
+        return result;
+    }
+} // namespace radix
+
+#endif // ASOF_JOIN_RADIX_PARTITION_HPP
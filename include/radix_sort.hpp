@@ -0,0 +1,182 @@
+#ifndef ASOF_JOIN_RADIX_SORT_HPP
+#define ASOF_JOIN_RADIX_SORT_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "tbb/parallel_for.h"
+#include "tbb/parallel_reduce.h"
+#include "tbb/task_arena.h"
+
+#include "radix_partition.hpp"
+
+/// LSD radix sort of join entries by their [[uint64_t]] key, a replacement for [[tbb::parallel_sort]]
+/// on the partition bins.
+///
+/// The keys are extracted once into (key - min, idx) tuples, such that the digit passes neither call
+/// the virtual [[get_key()]] nor move the (vtable carrying) entries. Only the digits below the highest
+/// set bit of max - min are sorted, and a digit on which all keys agree is skipped. Finally, the entries
+/// are permuted into their sorted order once. Equal keys keep their input order.
+namespace radix {
+    constexpr unsigned DIGIT_BITS = 8;
+    constexpr size_t NUM_BUCKETS = 1 << DIGIT_BITS;
+    /// Smaller ranges are sorted by (stable) comparisons.
+    constexpr size_t MIN_RADIX_SORT_SIZE = 256;
+    /// Larger ranges run every pass in parallel.
+    constexpr size_t MIN_PARALLEL_SORT_SIZE = 1 << 16;
+    /// Rows per task of a parallel pass.
+    constexpr size_t SORT_CHUNK_SIZE = 1 << 14;
+
+    using Histogram = std::array<size_t, NUM_BUCKETS>;
+
+    [[gnu::always_inline]] inline size_t digit_of(uint64_t key, unsigned shift) {
+        return (key >> shift) & (NUM_BUCKETS - 1);
+    }
+
+    /// Stable counting sort of [[in]] by the digit at [[shift]] into [[out]].
+    /// Returns false without writing [[out]] if all keys share that digit.
+    inline bool sort_digit(const std::vector<PartitionTuple>& in, std::vector<PartitionTuple>& out,
+                           unsigned shift) {
+        const size_t n = in.size();
+
+        if (n < MIN_PARALLEL_SORT_SIZE) {
+            Histogram offsets{};
+            for (const auto& tuple : in) {
+                ++offsets[digit_of(tuple.value, shift)];
+            }
+            if (offsets[digit_of(in[0].value, shift)] == n) {
+                return false;
+            }
+
+            size_t offset = 0;
+            for (auto& count : offsets) {
+                size_t bucket_size = count;
+                count = offset;
+                offset += bucket_size;
+            }
+            for (const auto& tuple : in) {
+                out[offsets[digit_of(tuple.value, shift)]++] = tuple;
+            }
+            return true;
+        }
+
+        const size_t num_chunks = (n + SORT_CHUNK_SIZE - 1) / SORT_CHUNK_SIZE;
+        std::vector<Histogram> offsets(num_chunks);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t chunk = range.begin(); chunk < range.end(); ++chunk) {
+                auto& counts = offsets[chunk];
+                counts.fill(0);
+                size_t end = std::min(n, (chunk + 1) * SORT_CHUNK_SIZE);
+                for (size_t i = chunk * SORT_CHUNK_SIZE; i < end; ++i) {
+                    ++counts[digit_of(in[i].value, shift)];
+                }
+            }
+        });
+
+        /// Exclusive prefix sum in bucket major order, such that every chunk writes into its own slice of each bucket.
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < NUM_BUCKETS; ++bucket) {
+            for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+                size_t count = offsets[chunk][bucket];
+                offsets[chunk][bucket] = offset;
+                offset += count;
+            }
+            if (offset == n && offsets[0][bucket] == 0) {
+                return false;
+            }
+        }
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t chunk = range.begin(); chunk < range.end(); ++chunk) {
+                auto& chunk_offsets = offsets[chunk];
+                size_t end = std::min(n, (chunk + 1) * SORT_CHUNK_SIZE);
+                for (size_t i = chunk * SORT_CHUNK_SIZE; i < end; ++i) {
+                    out[chunk_offsets[digit_of(in[i].value, shift)]++] = in[i];
+                }
+            }
+        });
+        return true;
+    }
+
+    /// Sort the entries in [first, last) by [[get_key()]]. Large ranges are sorted in parallel.
+    template<typename Iterator>
+    void sort(Iterator first, Iterator last) {
+        using Entry = std::iter_value_t<Iterator>;
+        const size_t n = static_cast<size_t>(last - first);
+
+        if (n < MIN_RADIX_SORT_SIZE) {
+            std::stable_sort(first, last, [](const Entry& lhs, const Entry& rhs) {
+                return lhs.get_key() < rhs.get_key();
+            });
+            return;
+        }
+
+        const bool parallel = n >= MIN_PARALLEL_SORT_SIZE;
+        auto for_each_row = [&](auto&& body) {
+            if (parallel) {
+                tbb::parallel_for(tbb::blocked_range<size_t>(0, n), [&](tbb::blocked_range<size_t>& range) {
+                    for (size_t i = range.begin(); i < range.end(); ++i) {
+                        body(i);
+                    }
+                });
+            } else {
+                for (size_t i = 0; i < n; ++i) {
+                    body(i);
+                }
+            }
+        };
+
+        std::vector<PartitionTuple> tuples(n);
+        std::vector<PartitionTuple> buffer(n);
+        for_each_row([&](size_t i) {
+            tuples[i] = {first[i].get_key(), i};
+        });
+
+        using MinMax = std::pair<uint64_t, uint64_t>;
+        auto min_max = [&](const tbb::blocked_range<size_t>& range, MinMax result) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                result.first = std::min(result.first, tuples[i].value);
+                result.second = std::max(result.second, tuples[i].value);
+            }
+            return result;
+        };
+        auto [min_key, max_key] = parallel
+            ? tbb::parallel_reduce(tbb::blocked_range<size_t>(0, n), MinMax{UINT64_MAX, 0}, min_max,
+                [](MinMax lhs, MinMax rhs) {
+                    return MinMax{std::min(lhs.first, rhs.first), std::max(lhs.second, rhs.second)};
+                })
+            : min_max(tbb::blocked_range<size_t>(0, n), MinMax{UINT64_MAX, 0});
+
+        if (min_key == max_key) {
+            return;
+        }
+
+        for_each_row([&](size_t i) {
+            tuples[i].value -= min_key;
+        });
+
+        /// Digits above the highest set bit of max - min are zero for every key.
+        const unsigned num_bits = std::bit_width(max_key - min_key);
+        for (unsigned shift = 0; shift < num_bits; shift += DIGIT_BITS) {
+            if (sort_digit(tuples, buffer, shift)) {
+                tuples.swap(buffer);
+            }
+        }
+
+        std::vector<Entry> sorted(n);
+        for_each_row([&](size_t i) {
+            sorted[i] = std::move(first[tuples[i].idx]);
+        });
+        for_each_row([&](size_t i) {
+            first[i] = std::move(sorted[i]);
+        });
+    }
+} // namespace radix
+
+#endif // ASOF_JOIN_RADIX_SORT_HPP
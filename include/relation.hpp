@@ -1,13 +1,16 @@
 #ifndef ASOF_JOIN_RELATION_HPP
 #define ASOF_JOIN_RELATION_HPP
 
+#include <memory>
 #include <utility>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <cstdint>
 
 #include "tuple_buffer.hpp"
+#include "symbol_dictionary.hpp"
 
 #include "tbb/enumerable_thread_specific.h"
 
@@ -19,6 +22,8 @@ struct Prices : Relation {
     std::vector<uint64_t> timestamps;
     std::vector<std::string> stock_ids;
     std::vector<uint64_t> prices;
+    /// Dictionary encoded [[stock_ids]] using [[SymbolDictionary::shared()]].
+    std::vector<SymbolId> symbol_ids;
 
     Prices(std::vector<uint64_t>& timestamps,
            std::vector<std::string>& stock_ids,
@@ -27,12 +32,25 @@ struct Prices : Relation {
         Relation(size),
         timestamps(std::move(timestamps)),
         stock_ids(std::move(stock_ids)),
-        prices(std::move(prices)) {};
+        prices(std::move(prices)),
+        symbol_ids(SymbolDictionary::shared().encode(this->stock_ids)) {};
+
+    Prices(std::vector<uint64_t>& timestamps,
+           std::vector<std::string>& stock_ids,
+           std::vector<SymbolId>& symbol_ids,
+           std::vector<uint64_t>& prices,
+           size_t size):
+        Relation(size),
+        timestamps(std::move(timestamps)),
+        stock_ids(std::move(stock_ids)),
+        prices(std::move(prices)),
+        symbol_ids(std::move(symbol_ids)) {};
 
     [[nodiscard]] size_t total_size() const {
         size_t total_size = sizeof(Prices);
         total_size += timestamps.size() * sizeof(uint64_t);
         total_size += prices.size() * sizeof(uint64_t);
+        total_size += symbol_ids.size() * sizeof(SymbolId);
         total_size += stock_ids.size() * sizeof(std::string);
         for (const auto& stock_id : stock_ids) {
             total_size += stock_id.size();
@@ -41,6 +59,7 @@ struct Prices : Relation {
     }
 };
 
+/// Loads a csv file or, if [[path]] ends with [[columnar::FILE_EXTENSION]], a columnar file.
 Prices load_prices(std::string_view path, char delimiter = ',', bool shuffle = false);
 Prices generate_equal_distributed_prices(size_t num_prices, size_t price_sampling_rate, size_t num_diff_stocks);
 Prices generate_uniform_prices(size_t num_prices, size_t max_timestamp, size_t num_diff_stocks);
@@ -51,20 +70,35 @@ struct OrderBook : Relation {
     std::vector<uint64_t> timestamps;
     std::vector<std::string> stock_ids;
     std::vector<uint64_t> amounts;
+    /// Dictionary encoded [[stock_ids]] using [[SymbolDictionary::shared()]].
+    std::vector<SymbolId> symbol_ids;
+
+    OrderBook(std::vector<uint64_t>& timestamps,
+              std::vector<std::string>& stock_ids,
+              std::vector<uint64_t>& amounts,
+              size_t size):
+        Relation(size),
+        timestamps(std::move(timestamps)),
+        stock_ids(std::move(stock_ids)),
+        amounts(std::move(amounts)),
+        symbol_ids(SymbolDictionary::shared().encode(this->stock_ids)) {};
 
     OrderBook(std::vector<uint64_t>& timestamps,
               std::vector<std::string>& stock_ids,
+              std::vector<SymbolId>& symbol_ids,
               std::vector<uint64_t>& amounts,
               size_t size):
         Relation(size),
         timestamps(std::move(timestamps)),
         stock_ids(std::move(stock_ids)),
-        amounts(std::move(amounts)) {};
+        amounts(std::move(amounts)),
+        symbol_ids(std::move(symbol_ids)) {};
 
     [[nodiscard]] size_t total_size() const {
         size_t total_size = sizeof(OrderBook);
         total_size += timestamps.size() * sizeof(uint64_t);
         total_size += amounts.size() * sizeof(uint64_t);
+        total_size += symbol_ids.size() * sizeof(SymbolId);
         total_size += stock_ids.size() * sizeof(std::string);
         for (const auto& stock_id : stock_ids) {
             total_size += stock_id.size();
@@ -74,6 +108,10 @@ struct OrderBook : Relation {
 };
 
 OrderBook load_order_book(std::string_view path, char delimiter = ',', bool shuffle = false);
+/// Load both relations concurrently.
+std::pair<Prices, OrderBook> load_prices_and_order_book(
+        std::string_view prices_path, std::string_view order_book_path,
+        char delimiter = ',', bool shuffle = false);
 OrderBook generate_uniform_orderbook(size_t num_orders, size_t max_timestamp, size_t num_diff_stocks);
 OrderBook generate_uniform_orderbook(
         size_t num_orders, size_t min_timestamp, size_t max_timestamp, size_t num_diff_stocks);
@@ -83,37 +121,115 @@ OrderBook generate_zipf_uniform_orderbook_parallel(
         size_t num_orders, size_t max_timestamp, size_t num_diff_stocks, double zipf_skew);
 OrderBook select_first_n_orders(OrderBook& order_book, size_t n);
 
+/// Fixed size chunk of result rows, stored column wise.
+/// The stock id of the price equals the stock id of the order and is not stored twice.
+struct ResultChunk {
+    static constexpr size_t CAPACITY = 1 << 14;
+
+    uint64_t prices_timestamps[CAPACITY];
+    uint64_t prices[CAPACITY];
+    uint64_t order_book_timestamps[CAPACITY];
+    std::string_view order_book_stock_ids[CAPACITY];
+    /// [[SymbolId]]s of [[order_book_stock_ids]], such that writers do not encode the stock ids again.
+    SymbolId order_book_symbol_ids[CAPACITY];
+    uint64_t amounts[CAPACITY];
+    uint64_t values[CAPACITY];
+};
+
+/// Fixed size chunk of matches as (order_idx, price_idx) pairs, see [[ResultRelation::insert_match]].
+struct MatchChunk {
+    static constexpr size_t CAPACITY = 1 << 14;
+
+    size_t order_idxs[CAPACITY];
+    size_t price_idxs[CAPACITY];
+};
+
+/// Chunk of result rows of a single thread and the position of its first row in [[ResultRelation::gather]].
+/// Either [[rows]] holds eagerly inserted rows or [[matches]] late materialized ones.
+struct ResultChunkView {
+    const ResultChunk* rows;
+    const MatchChunk* matches;
+    size_t num_rows;
+    size_t offset;
+};
+
+/// Aggregate of all matches of a single stock, see [[ResultRelation::aggregate]].
+struct StockAggregate {
+    /// Sum of price * amount.
+    uint64_t value_sum = 0;
+    uint64_t amount_sum = 0;
+    size_t count = 0;
+
+    /// Volume weighted average price.
+    [[nodiscard]] double vwap() const {
+        return amount_sum == 0 ? 0.0 : static_cast<double>(value_sum) / static_cast<double>(amount_sum);
+    }
+};
+
+/// All result rows gathered into contiguous columns.
+struct ResultColumns {
+    std::vector<uint64_t> prices_timestamps;
+    std::vector<uint64_t> prices;
+    std::vector<uint64_t> order_book_timestamps;
+    std::vector<std::string_view> order_book_stock_ids;
+    std::vector<SymbolId> order_book_symbol_ids;
+    std::vector<uint64_t> amounts;
+    std::vector<uint64_t> values;
+};
+
 struct ResultRelation : Relation {
 
-    ResultRelation(): Relation(), value_sum(0) {}
+    ResultRelation(): Relation(), value_sum(0), num_unmatched(0) {}
 
     uint64_t value_sum;
+    /// Number of rows inserted with [[insert_unmatched]], which are included in [[size]].
+    size_t num_unmatched;
+
+    /// Value (and price) of an order without a matching price in a LEFT OUTER join.
+    static constexpr uint64_t NULL_VALUE = UINT64_MAX;
 
+    /// Price index of an unmatched order inserted with [[insert_match]].
+    static constexpr size_t NO_MATCH = SIZE_MAX;
+
+    /// Rows inserted by a single thread. Rows are appended to mmap'd chunks, which are never
+    /// reallocated, i.e. rows are not copied until they are gathered.
     struct OutputData {
-        size_t batch_size = 1024;
-
-        std::vector<uint64_t> prices_timestamps;
-        std::vector<std::string_view> prices_stock_ids;
-        std::vector<uint64_t> prices;
-        std::vector<uint64_t> order_book_timestamps;
-        std::vector<std::string_view> order_book_stock_ids;
-        std::vector<uint64_t> amounts;
-        std::vector<uint64_t> values;
-        size_t batch_idx;
-        size_t size;
-        size_t value_sum;
-
-        OutputData():
-            prices_timestamps(batch_size),
-            prices_stock_ids(batch_size),
-            prices(batch_size),
-            order_book_timestamps(batch_size),
-            order_book_stock_ids(batch_size),
-            amounts(batch_size),
-            values(batch_size),
-            batch_idx(0),
-            size(0),
-            value_sum(0) {}
+        std::vector<std::unique_ptr<Buffer>> buffers;
+        std::vector<ResultChunk*> chunks;
+        size_t size = 0;
+        size_t num_unmatched = 0;
+        size_t value_sum = 0;
+
+        /// Aggregates indexed by the [[SymbolId]] of the order and number of aggregated rows.
+        std::vector<StockAggregate> aggregates;
+        size_t num_aggregated = 0;
+
+        /// Late materialized matches.
+        std::vector<std::unique_ptr<Buffer>> match_buffers;
+        std::vector<MatchChunk*> match_chunks;
+        size_t num_matches = 0;
+
+        [[gnu::always_inline]] inline std::pair<MatchChunk*, size_t> next_match() {
+            size_t idx = num_matches & (MatchChunk::CAPACITY - 1);
+            if (idx == 0) {
+                auto buffer = Buffer::create(sizeof(MatchChunk));
+                match_chunks.push_back(new (buffer->data()) MatchChunk);
+                match_buffers.push_back(std::move(buffer));
+            }
+            ++num_matches;
+            return {match_chunks.back(), idx};
+        }
+
+        [[gnu::always_inline]] inline std::pair<ResultChunk*, size_t> next_row() {
+            size_t idx = size & (ResultChunk::CAPACITY - 1);
+            if (idx == 0) {
+                auto buffer = Buffer::create(sizeof(ResultChunk));
+                chunks.push_back(new (buffer->data()) ResultChunk);
+                buffers.push_back(std::move(buffer));
+            }
+            ++size;
+            return {chunks.back(), idx};
+        }
     };
 
     tbb::enumerable_thread_specific<OutputData> thread_data;
@@ -125,74 +241,123 @@ struct ResultRelation : Relation {
         uint64_t price,
         uint64_t order_book_timestamp,
         std::string_view order_book_stock_id,
+        SymbolId order_book_symbol_id,
         uint64_t amount) {
 
         auto& data = thread_data.local();
-        size_t idx = data.batch_idx & (data.batch_size - 1);
-
-        //data.prices_timestamps[idx] = price_timestamp;
-        //data.prices_stock_ids[idx] = price_stock_id;
-        //data.prices[idx] = price;
-
-        data.order_book_timestamps[idx] = order_book_timestamp;
-        data.order_book_stock_ids[idx] = order_book_stock_id;
-        //data.amounts[idx] = amount;
+        auto [chunk, idx] = data.next_row();
 
         size_t value = price * amount;
-        data.values[idx] = value;
+        chunk->prices_timestamps[idx] = price_timestamp;
+        chunk->prices[idx] = price;
+        chunk->order_book_timestamps[idx] = order_book_timestamp;
+        chunk->order_book_stock_ids[idx] = order_book_stock_id;
+        chunk->order_book_symbol_ids[idx] = order_book_symbol_id;
+        chunk->amounts[idx] = amount;
+        chunk->values[idx] = value;
         data.value_sum += value;
+    }
+
+    /// Insert an order without a matching price. Its price and value are [[NULL_VALUE]] and
+    /// it does not contribute to [[value_sum]].
+    inline void insert_unmatched(
+        uint64_t order_book_timestamp,
+        std::string_view order_book_stock_id,
+        SymbolId order_book_symbol_id,
+        uint64_t amount) {
 
-        ++data.size;
-        ++data.batch_idx;
+        auto& data = thread_data.local();
+        auto [chunk, idx] = data.next_row();
+
+        chunk->prices_timestamps[idx] = NULL_VALUE;
+        chunk->prices[idx] = NULL_VALUE;
+        chunk->order_book_timestamps[idx] = order_book_timestamp;
+        chunk->order_book_stock_ids[idx] = order_book_stock_id;
+        chunk->order_book_symbol_ids[idx] = order_book_symbol_id;
+        chunk->amounts[idx] = amount;
+        chunk->values[idx] = NULL_VALUE;
+        ++data.num_unmatched;
+    }
 
-        //data.prices_timestamps.push_back(price_timestamp);
-        //data.prices_stock_ids.push_back(price_stock_id);
-        //data.prices.push_back(price);
+    /// Late materialization: only store the positions of the matched rows. The payload is fetched
+    /// in bulk by [[finalize(prices, order_book)]] and [[gather]]. Unmatched orders use [[NO_MATCH]].
+    inline void insert_match(size_t order_idx, size_t price_idx) {
+        auto [chunk, idx] = thread_data.local().next_match();
+        chunk->order_idxs[idx] = order_idx;
+        chunk->price_idxs[idx] = price_idx;
+    }
 
-        //data.order_book_timestamps.push_back(order_book_timestamp);
-        //data.order_book_stock_ids.push_back(order_book_stock_id);
-        //data.amounts.push_back(amount);
+    /// Fold a match into the aggregate of its stock without storing a row.
+    /// The match counts towards [[size]] and [[value_sum]], but is not part of [[gather]].
+    inline void aggregate(SymbolId symbol_id, uint64_t price, uint64_t amount) {
+        auto& data = thread_data.local();
+        if (symbol_id >= data.aggregates.size()) [[unlikely]] {
+            data.aggregates.resize(SymbolDictionary::shared().size());
+        }
 
-        //data.values.push_back(price * amount);
+        size_t value = price * amount;
+        auto& aggregate = data.aggregates[symbol_id];
+        aggregate.value_sum += value;
+        aggregate.amount_sum += amount;
+        ++aggregate.count;
+        data.value_sum += value;
+        ++data.num_aggregated;
+    }
+
+    /// Count an order without a matching price for aggregating LEFT OUTER joins.
+    inline void aggregate_unmatched() {
+        auto& data = thread_data.local();
+        ++data.num_unmatched;
+        ++data.num_aggregated;
     }
 
     void finalize() {
         size_t total_size = 0;
         for (auto& data : thread_data) {
-            total_size += data.size;
+            total_size += data.size + data.num_aggregated;
+            num_unmatched += data.num_unmatched;
             value_sum += data.value_sum;
         }
         size = total_size;
     }
 
+    /// Finalize a result which may contain late materialized matches of [[prices]] and [[order_book]].
+    /// Computes the value sum of the matches in parallel, which only fetches prices and amounts.
+    /// Both relations must outlive the result.
+    void finalize(const Prices& prices, const OrderBook& order_book);
+
     void reset() {
         thread_data.clear();
+        size = 0;
+        num_unmatched = 0;
+        value_sum = 0;
+        matched_prices = nullptr;
+        matched_order_book = nullptr;
     }
 
-    std::vector<uint64_t> collect_values() {
-        std::vector<uint64_t> all_values;
-        for (auto& data : thread_data) {
-            auto count = std::min(data.size, data.batch_size);
-            all_values.insert(all_values.end(), data.values.begin(), data.values.begin() + count);
-        }
-        return all_values;
-    }
+    /// Merge the aggregates of all threads. The result is indexed by [[SymbolId]],
+    /// stocks without a match have an empty aggregate.
+    std::vector<StockAggregate> collect_aggregates();
 
-    void print() {
-        std::cout
-            << "Price t, Price Stock, Price, "
-            << "OrderBook t, OrderBook Stock, Amount, Value" << std::endl;
-        //for (size_t i = 0; i < size; ++i) {
-        //    std::cout
-        //        << prices_timestamps[i] << ","
-        //        << prices_stock_ids[i] << ","
-        //        << prices[i] << ","
-        //        << order_book_timestamps[i] << ","
-        //        << order_book_stock_ids[i] << ","
-        //        << amounts[i] << ","
-        //        << values[i] << std::endl;
-        //}
-    }
+    /// Gather the rows of all threads in parallel into contiguous columns.
+    ResultColumns gather();
+
+    /// Chunks of all threads in [[gather]] order, such that consumers like [[result_writer]] process
+    /// every chunk on its own instead of gathering the whole result first.
+    std::vector<ResultChunkView> chunk_views();
+
+    /// Rows of [[view]]. Eager chunks are returned as is, late materialized matches are fetched into [[buffer]].
+    const ResultChunk& chunk_rows(const ResultChunkView& view, ResultChunk& buffer) const;
+
+    /// Gather only the values of all rows.
+    std::vector<uint64_t> collect_values();
+
+    void print();
+
+private:
+    /// Relations of the late materialized matches.
+    const Prices* matched_prices = nullptr;
+    const OrderBook* matched_order_book = nullptr;
 };
 
 #endif //ASOF_JOIN_RELATION_HPP
@@ -0,0 +1,55 @@
+#ifndef ASOF_JOIN_RESULT_WRITER_HPP
+#define ASOF_JOIN_RESULT_WRITER_HPP
+
+#include <cstdint>
+#include <string_view>
+
+#include "relation.hpp"
+#include "symbol_dictionary.hpp"
+
+/// Parallel writers which persist a [[ResultRelation]].
+///
+/// The chunks of rows inserted by the join threads are formatted in parallel, without gathering the
+/// result first. Every chunk knows its position in the output file up front, so the threads write into
+/// disjoint regions of the file without any synchronization.
+namespace result_writer {
+    /// Number of rows read by a single task.
+    constexpr size_t BLOCK_SIZE = 1 << 14;
+
+    /// Write the result as csv with the columns
+    /// price_timestamp,stock_id,price,order_book_timestamp,amount,value.
+    /// Price fields and values of unmatched orders are empty. The file is written through a shared mapping.
+    void write_csv(ResultRelation& result, std::string_view path, char delimiter = ',');
+
+    /// Binary columnar layout of a result, analogous to [[columnar::ColumnarFile]]:
+    ///   [[ResultFileHeader]]
+    ///   prices_timestamps, prices, order_book_timestamps, amounts, values:  uint64_t[num_rows] each
+    ///   symbol_ids:  SymbolId[num_rows]  (stock ids of the orders)
+    ///   dictionary:  uint64_t[num_symbols + 1] string offsets, followed by the symbol bytes
+    /// Unmatched orders store [[ResultRelation::NULL_VALUE]]. Every section is 64 byte aligned.
+    constexpr std::string_view FILE_EXTENSION = ".res";
+    constexpr char MAGIC[8] = {'A', 'S', 'O', 'F', 'R', 'E', 'S', '\0'};
+    constexpr uint32_t VERSION = 1;
+    constexpr size_t NUM_VALUE_COLUMNS = 5;
+
+    struct ResultFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t symbol_id_size;
+        uint64_t num_rows;
+        uint64_t num_symbols;
+        /// Offsets of prices_timestamps, prices, order_book_timestamps, amounts and values.
+        uint64_t value_offsets[NUM_VALUE_COLUMNS];
+        uint64_t symbol_ids_offset;
+        uint64_t dictionary_offset;
+    };
+
+    /// Write the result in the binary layout. The columns are written with pwrite in parallel.
+    void write_binary(ResultRelation& result, std::string_view path);
+
+    /// Read a file written by [[write_binary]]. The stock ids are views into [[SymbolDictionary::shared()]].
+    /// Throws if [[path]] is not a valid result file.
+    ResultColumns read_binary(std::string_view path);
+} // namespace result_writer
+
+#endif // ASOF_JOIN_RESULT_WRITER_HPP
@@ -1,9 +1,15 @@
 #ifndef ASOF_JOIN_SEARCHES_HPP
 #define ASOF_JOIN_SEARCHES_HPP
 
+#include <algorithm>
+#include <bit>
 #include <vector>
 #include <cstdint>
 
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
 #include "asof_join.hpp"
 
 template <typename T>
@@ -124,17 +130,18 @@ namespace Search::Interpolation {
         }
 
         // Perform exponential search from the interpolated position.
+        // Keys equal to the target are skipped to the right, such that the last of them is found.
         bool overestimated;
         size_t bound = 1;
-        if (data[pos].get_key() >= target) {
+        if (data[pos].get_key() > target) {
             overestimated = true;
             /// while (bound - pos >= 0 && ...
-            while (bound <= pos && data[pos - bound].get_key() >= target) {
+            while (bound <= pos && data[pos - bound].get_key() > target) {
                 bound *= 2;
             }
         } else {
             overestimated = false;
-            while (pos + bound < n && data[pos + bound].get_key() < target) {
+            while (pos + bound < n && data[pos + bound].get_key() <= target) {
                 bound *= 2;
             }
         }
@@ -197,4 +204,555 @@ namespace Search::Interpolation {
     }
 } // namespace Search::Interpolation
 
+
+/// Searches starting at a cursor [[start]], used to resolve ascending targets in a single merge pass.
+/// The distance to the result is doubled until it is bracketed, followed by a binary search, so
+/// close targets cost a few sequential accesses instead of a full search.
+namespace Search::Galloping {
+    namespace detail {
+        /// First position >= [[start]] whose key is not [[before(key)]], given keys before [[start]] are.
+        template <typename T, typename Before>
+        inline size_t gallop(const std::vector<T>& data, size_t start, Before before) {
+            size_t n = data.size();
+            size_t left = start;
+            size_t bound = 1;
+            while (start + bound - 1 < n && before(data[start + bound - 1].get_key())) {
+                left = start + bound;
+                bound *= 2;
+            }
+            size_t right = std::min(start + bound - 1, n);
+
+            while (left < right) {
+                size_t middle = left + (right - left) / 2;
+
+                bool is_before = before(data[middle].get_key());
+                left = is_before ? middle + 1 : left;
+                right = is_before ? right : middle;
+            }
+            return left;
+        }
+    } // namespace detail
+
+    /// Position of the first value >= [[target]], where all values before [[start]] are smaller.
+    template <typename T, typename = IsJoinEntry<T>>
+    inline size_t lower_bound(const std::vector<T>& data, size_t start, uint64_t target) {
+        return detail::gallop(data, start, [target](uint64_t key) { return key < target; });
+    }
+
+    /// Position of the first value > [[target]], where all values before [[start]] are less or equal.
+    template <typename T, typename = IsJoinEntry<T>>
+    inline size_t upper_bound(const std::vector<T>& data, size_t start, uint64_t target) {
+        return detail::gallop(data, start, [target](uint64_t key) { return key <= target; });
+    }
+} // namespace Search::Galloping
+
+
+/// Branchless searches on a key-only shadow of a sorted bin in Eytzinger (BFS) order, i.e. the
+/// children of node [[k]] are [[2k]] and [[2k + 1]]. The first levels of the tree share a few cache
+/// lines, and the descendants four levels below a node are contiguous, so they are prefetched while
+/// the search descends.
+namespace Search::Eytzinger {
+    struct Layout {
+        /// 1-indexed keys in Eytzinger order, [[keys[0]]] is unused.
+        std::vector<uint64_t> keys;
+        /// Position in the sorted bin of every key.
+        std::vector<size_t> positions;
+
+        Layout() = default;
+
+        template <typename T, typename = IsJoinEntry<T>>
+        explicit Layout(const std::vector<T>& data): keys(data.size() + 1), positions(data.size() + 1) {
+            size_t i = 0;
+            fill(data, i, 1);
+        }
+
+        [[nodiscard]] size_t size() const {
+            return keys.empty() ? 0 : keys.size() - 1;
+        }
+
+    private:
+        /// In-order traversal of the tree, which assigns the sorted keys to their nodes.
+        template <typename T>
+        void fill(const std::vector<T>& data, size_t& i, size_t k) {
+            if (k <= data.size()) {
+                fill(data, i, 2 * k);
+                keys[k] = data[i].get_key();
+                positions[k] = i++;
+                fill(data, i, 2 * k + 1);
+            }
+        }
+    };
+
+    namespace detail {
+        /// Nodes prefetched ahead, i.e. the 16 descendants four levels down fill two cache lines.
+        constexpr size_t PREFETCH_NODES = 16;
+
+        /// Position in the sorted bin of the first key for which [[before(key)]] is false, or the bin size.
+        template <typename Before>
+        [[gnu::always_inline]] inline size_t search(const Layout& layout, Before before) {
+            const uint64_t* keys = layout.keys.data();
+            const size_t n = layout.size();
+            size_t k = 1;
+            while (k <= n) {
+                __builtin_prefetch(keys + std::min(PREFETCH_NODES * k, n));
+                k = 2 * k + before(keys[k]);
+            }
+            /// Undo the right turns after the last left turn, which leads to the first key not before.
+            k >>= __builtin_ffsll(static_cast<long long>(~k));
+            return k == 0 ? n : layout.positions[k];
+        }
+    } // namespace detail
+
+    /// Find the last value which is less or equal than [[target]], [[layout]] has to be built from [[data]].
+    template <typename T, typename = IsJoinEntry<T>>
+    inline T* less_equal_than(std::vector<T>& data, const Layout& layout, uint64_t target) {
+        size_t upper = detail::search(layout, [target](uint64_t key) { return key <= target; });
+        return upper > 0 ? &data[upper - 1] : nullptr;
+    }
+
+    /// Find the first value which is greater or equal than [[target]], [[layout]] has to be built from [[data]].
+    template <typename T, typename = IsJoinEntry<T>>
+    inline T* greater_equal_than(std::vector<T>& data, const Layout& layout, uint64_t target) {
+        size_t lower = detail::search(layout, [target](uint64_t key) { return key < target; });
+        return lower < data.size() ? &data[lower] : nullptr;
+    }
+} // namespace Search::Eytzinger
+
+
+/// Pointer-free k-ary search tree (S-tree) over the keys of a sorted bin. Every node holds
+/// [[NODE_KEYS]] keys in one cache line and its [[FANOUT]] children are found by index arithmetic,
+/// i.e. the children of node [[k]] are [[k * FANOUT + 1 + i]]. A node is ranked with a single
+/// AVX-512 or two AVX2 comparisons, selected at runtime like [[csv::avx2_supported]].
+namespace Search::KAry {
+    constexpr size_t NODE_KEYS = 8;
+    constexpr size_t FANOUT = NODE_KEYS + 1;
+
+    struct alignas(64) Node {
+        uint64_t keys[NODE_KEYS];
+    };
+
+    struct Layout {
+        std::vector<Node> nodes;
+        /// Position in the sorted bin of every key slot, the bin size for padding slots.
+        std::vector<size_t> positions;
+        size_t num_keys = 0;
+
+        Layout() = default;
+
+        template <typename T, typename = IsJoinEntry<T>>
+        explicit Layout(const std::vector<T>& data): nodes((data.size() + NODE_KEYS - 1) / NODE_KEYS),
+                positions(nodes.size() * NODE_KEYS), num_keys(data.size()) {
+            size_t i = 0;
+            fill(data, i, 0);
+        }
+
+        [[nodiscard]] size_t size() const {
+            return num_keys;
+        }
+
+    private:
+        /// In-order traversal of the tree, which assigns the sorted keys to their slots.
+        /// Slots after the last key are padded with the maximal key.
+        template <typename T>
+        void fill(const std::vector<T>& data, size_t& i, size_t k) {
+            if (k >= nodes.size()) {
+                return;
+            }
+            for (size_t slot = 0; slot < NODE_KEYS; ++slot) {
+                fill(data, i, k * FANOUT + 1 + slot);
+                nodes[k].keys[slot] = i < data.size() ? data[i].get_key() : UINT64_MAX;
+                positions[k * NODE_KEYS + slot] = i < data.size() ? i++ : data.size();
+            }
+            fill(data, i, k * FANOUT + NODE_KEYS + 1);
+        }
+    };
+
+    namespace detail {
+        /// Descend from the root to a leaf, where [[RANK]] is the number of keys of node [[k]] smaller than
+        /// the target. The position of the first key >= target is the last one passed on the way down.
+#define KARY_LOWER_BOUND(RANK)                                            \
+        size_t result = layout.size();                                    \
+        size_t k = 0;                                                     \
+        while (k < layout.nodes.size()) {                                 \
+            size_t i = (RANK);                                            \
+            if (i < NODE_KEYS) {                                          \
+                result = layout.positions[k * NODE_KEYS + i];             \
+            }                                                             \
+            k = k * FANOUT + 1 + i;                                       \
+        }                                                                 \
+        return result;
+
+        inline size_t lower_bound_scalar(const Layout& layout, uint64_t target) {
+            auto rank = [&](const Node& node) {
+                size_t count = 0;
+                for (size_t i = 0; i < NODE_KEYS; ++i) {
+                    count += node.keys[i] < target;
+                }
+                return count;
+            };
+            KARY_LOWER_BOUND(rank(layout.nodes[k]))
+        }
+
+#ifdef __x86_64__
+        [[gnu::target("avx2")]]
+        inline size_t rank_avx2(const Node& node, __m256i needle, __m256i sign) {
+            auto* keys = reinterpret_cast<const __m256i*>(node.keys);
+            __m256i low = _mm256_xor_si256(_mm256_load_si256(keys), sign);
+            __m256i high = _mm256_xor_si256(_mm256_load_si256(keys + 1), sign);
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, low))) |
+                       _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, high))) << 4;
+            return static_cast<size_t>(__builtin_popcount(mask));
+        }
+
+        [[gnu::target("avx2")]]
+        inline size_t lower_bound_avx2(const Layout& layout, uint64_t target) {
+            /// AVX2 only compares signed integers, so the sign bit of both sides is flipped.
+            const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+            const __m256i needle = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(target)), sign);
+            KARY_LOWER_BOUND(rank_avx2(layout.nodes[k], needle, sign))
+        }
+
+        [[gnu::target("avx512f")]]
+        inline size_t rank_avx512(const Node& node, __m512i needle) {
+            __mmask8 mask = _mm512_cmplt_epu64_mask(_mm512_load_si512(node.keys), needle);
+            return static_cast<size_t>(__builtin_popcount(mask));
+        }
+
+        [[gnu::target("avx512f")]]
+        inline size_t lower_bound_avx512(const Layout& layout, uint64_t target) {
+            const __m512i needle = _mm512_set1_epi64(static_cast<int64_t>(target));
+            KARY_LOWER_BOUND(rank_avx512(layout.nodes[k], needle))
+        }
+#endif
+#undef KARY_LOWER_BOUND
+
+        /// Position in the sorted bin of the first key >= [[target]], or the bin size.
+        inline size_t lower_bound(const Layout& layout, uint64_t target) {
+#ifdef __x86_64__
+            static const bool avx512_supported = __builtin_cpu_supports("avx512f");
+            static const bool avx2_supported = __builtin_cpu_supports("avx2");
+            if (avx512_supported) {
+                return lower_bound_avx512(layout, target);
+            }
+            if (avx2_supported) {
+                return lower_bound_avx2(layout, target);
+            }
+#endif
+            return lower_bound_scalar(layout, target);
+        }
+    } // namespace detail
+
+    /// Find the last value which is less or equal than [[target]], [[layout]] has to be built from [[data]].
+    template <typename T, typename = IsJoinEntry<T>>
+    inline T* less_equal_than(std::vector<T>& data, const Layout& layout, uint64_t target) {
+        size_t upper = target == UINT64_MAX ? data.size() : detail::lower_bound(layout, target + 1);
+        return upper > 0 ? &data[upper - 1] : nullptr;
+    }
+
+    /// Find the first value which is greater or equal than [[target]], [[layout]] has to be built from [[data]].
+    template <typename T, typename = IsJoinEntry<T>>
+    inline T* greater_equal_than(std::vector<T>& data, const Layout& layout, uint64_t target) {
+        size_t lower = detail::lower_bound(layout, target);
+        return lower < data.size() ? &data[lower] : nullptr;
+    }
+} // namespace Search::KAry
+
+
+/// RadixSpline learned index over the keys of a sorted bin. A greedy spline corridor approximates the
+/// lower bound position of every key within [[MAX_ERROR]], and a radix table over the leading bits of
+/// the keys narrows the spline segment of a target. A lookup evaluates the spline once and finishes
+/// with a binary search over at most 2 * [[MAX_ERROR]] + 2 entries.
+namespace Search::Learned {
+    /// Maximal distance between the spline estimate and the true position of a target.
+    constexpr size_t MAX_ERROR = 32;
+    /// Upper bound of the radix table size in bits, smaller splines use about two slots per knot.
+    constexpr unsigned MAX_RADIX_BITS = 18;
+
+    struct Knot {
+        uint64_t key;
+        double position;
+    };
+
+    struct Layout {
+        std::vector<Knot> knots;
+        /// [[radix_table[p]]] is the first knot whose key has the prefix [[p]] or a larger one.
+        std::vector<uint32_t> radix_table;
+        uint64_t min_key = 0;
+        uint64_t max_key = 0;
+        unsigned shift = 0;
+        size_t num_keys = 0;
+
+        Layout() = default;
+
+        /// Build the spline in one pass over the sorted [[data]].
+        template <typename T, typename = IsJoinEntry<T>>
+        explicit Layout(const std::vector<T>& data): num_keys(data.size()) {
+            if (data.empty()) {
+                return;
+            }
+            min_key = data.front().get_key();
+            max_key = data.back().get_key();
+
+            /// The lower bound of all targets in (a, b] of consecutive distinct keys is the position of b.
+            /// Adding (a + 1, pos(b)) keeps this step within the error bound between the knots.
+            add_point(min_key, 0);
+            for (size_t i = 1; i < data.size(); ++i) {
+                uint64_t prev_key = data[i - 1].get_key();
+                uint64_t key = data[i].get_key();
+                if (key != prev_key) {
+                    if (key - prev_key > 1) {
+                        add_point(prev_key + 1, i);
+                    }
+                    add_point(key, i);
+                }
+            }
+            if (knots.back().key != prev_point.key) {
+                knots.push_back(prev_point);
+            }
+
+            build_radix_table();
+        }
+
+        [[nodiscard]] size_t size() const {
+            return num_keys;
+        }
+
+        /// Estimated position of the first key >= [[target]], for [[min_key]] < [[target]] <= [[max_key]].
+        [[nodiscard]] inline size_t estimate(uint64_t target) const {
+            size_t prefix = (target - min_key) >> shift;
+            auto begin = knots.begin() + radix_table[prefix];
+            auto end = knots.begin() + std::min<size_t>(radix_table[prefix + 1] + 1, knots.size());
+            auto right = std::lower_bound(begin, end, target, [](const Knot& knot, uint64_t key) {
+                return knot.key < key;
+            });
+            auto left = right - 1;
+            double position = left->position + static_cast<double>(target - left->key) *
+                (right->position - left->position) / static_cast<double>(right->key - left->key);
+            return static_cast<size_t>(position);
+        }
+
+    private:
+        Knot prev_point{};
+        /// Slopes of the corridor from the last knot.
+        Knot upper_limit{};
+        Knot lower_limit{};
+        size_t num_points = 0;
+
+        /// Sign of the cross product, i.e. > 0 if the direction (dx2, dy2) is clockwise of (dx1, dy1).
+        static inline double orientation(double dx1, double dy1, double dx2, double dy2) {
+            return dy1 * dx2 - dy2 * dx1;
+        }
+
+        /// Greedy spline corridor: a new knot is only placed once a point leaves the corridor of the
+        /// lines from the last knot which pass all previous points within [[MAX_ERROR]].
+        void add_point(uint64_t key, size_t position) {
+            const double y = static_cast<double>(position);
+            const auto error = static_cast<double>(MAX_ERROR);
+            if (num_points++ == 0) {
+                knots.push_back({key, y});
+            } else if (num_points == 2) {
+                upper_limit = {key, y + error};
+                lower_limit = {key, y - error};
+            } else {
+                const Knot& last = knots.back();
+                const auto dx = static_cast<double>(key - last.key);
+                const auto upper_dx = static_cast<double>(upper_limit.key - last.key);
+                const auto lower_dx = static_cast<double>(lower_limit.key - last.key);
+                const double upper_dy = upper_limit.position - last.position;
+                const double lower_dy = lower_limit.position - last.position;
+
+                if (orientation(upper_dx, upper_dy, dx, y - last.position) <= 0 ||
+                        orientation(lower_dx, lower_dy, dx, y - last.position) >= 0) {
+                    knots.push_back(prev_point);
+                    upper_limit = {key, y + error};
+                    lower_limit = {key, y - error};
+                } else {
+                    if (orientation(upper_dx, upper_dy, dx, y + error - last.position) > 0) {
+                        upper_limit = {key, y + error};
+                    }
+                    if (orientation(lower_dx, lower_dy, dx, y - error - last.position) < 0) {
+                        lower_limit = {key, y - error};
+                    }
+                }
+            }
+            prev_point = {key, y};
+        }
+
+        void build_radix_table() {
+            const unsigned key_bits = std::bit_width(max_key - min_key);
+            const unsigned radix_bits = std::min<unsigned>(MAX_RADIX_BITS, std::bit_width(knots.size()) + 1);
+            shift = key_bits > radix_bits ? key_bits - radix_bits : 0;
+
+            const size_t num_prefixes = ((max_key - min_key) >> shift) + 1;
+            radix_table.resize(num_prefixes + 1);
+            size_t prefix = 0;
+            for (size_t i = 0; i < knots.size(); ++i) {
+                size_t knot_prefix = (knots[i].key - min_key) >> shift;
+                while (prefix <= knot_prefix) {
+                    radix_table[prefix++] = static_cast<uint32_t>(i);
+                }
+            }
+            while (prefix <= num_prefixes) {
+                radix_table[prefix++] = static_cast<uint32_t>(knots.size());
+            }
+        }
+    };
+
+    namespace detail {
+        /// Position in the sorted bin of the first key >= [[target]], or the bin size.
+        template <typename T>
+        inline size_t lower_bound(const std::vector<T>& data, const Layout& layout, uint64_t target) {
+            const size_t n = data.size();
+            if (n == 0 || target <= layout.min_key) {
+                return 0;
+            }
+            if (target > layout.max_key) {
+                return n;
+            }
+
+            size_t estimate = layout.estimate(target);
+            size_t left = estimate > MAX_ERROR ? estimate - MAX_ERROR : 0;
+            size_t right = std::min(estimate + MAX_ERROR + 2, n);
+            /// Rounding of the spline may exceed the error bound, then the window is widened to the bin.
+            if (left > 0 && data[left - 1].get_key() >= target) {
+                left = 0;
+            }
+            if (right < n && data[right].get_key() < target) {
+                right = n;
+            }
+
+            while (left < right) {
+                size_t middle = left + (right - left) / 2;
+                bool is_valid_value = data[middle].get_key() >= target;
+                left = is_valid_value ? left : middle + 1;
+                right = is_valid_value ? middle : right;
+            }
+            return right;
+        }
+    } // namespace detail
+
+    /// Find the last value which is less or equal than [[target]], [[layout]] has to be built from [[data]].
+    template <typename T, typename = IsJoinEntry<T>>
+    inline T* less_equal_than(std::vector<T>& data, const Layout& layout, uint64_t target) {
+        size_t upper = target == UINT64_MAX ? data.size() : detail::lower_bound(data, layout, target + 1);
+        return upper > 0 ? &data[upper - 1] : nullptr;
+    }
+
+    /// Find the first value which is greater or equal than [[target]], [[layout]] has to be built from [[data]].
+    template <typename T, typename = IsJoinEntry<T>>
+    inline T* greater_equal_than(std::vector<T>& data, const Layout& layout, uint64_t target) {
+        size_t lower = detail::lower_bound(data, layout, target);
+        return lower < data.size() ? &data[lower] : nullptr;
+    }
+} // namespace Search::Learned
+
+
+/// Batched searches which keep [[GROUP_SIZE]] independent lookups in flight, i.e. asynchronous memory
+/// access chaining. Every lookup is a branchless binary search whose state lives in a slot. A step of a
+/// slot compares the previously prefetched key, prefetches the next one and moves on to the next slot,
+/// such that the cache misses of all slots overlap. Finished slots are refilled with the next lookup.
+namespace Search::Interleaved {
+    /// Number of lookups in flight.
+    constexpr size_t GROUP_SIZE = 16;
+
+    namespace detail {
+        /// Find the last value <= target if [[LESS_EQUAL]], else the first value >= target, of the
+        /// sorted bin [[bin_of(i)]] for every target [[i]]. Null bins have no result.
+        template <typename T, bool LESS_EQUAL, typename BinOf>
+        inline void search(BinOf&& bin_of, const uint64_t* targets, size_t count, T** results) {
+            struct Lookup {
+                T* data;
+                size_t size;
+                size_t base;
+                size_t len;
+                uint64_t target;
+                size_t idx;
+            };
+
+            auto before = [](uint64_t key, uint64_t target) {
+                return LESS_EQUAL ? key <= target : key < target;
+            };
+
+            size_t next = 0;
+            auto start = [&](Lookup& slot) {
+                while (next < count) {
+                    size_t i = next++;
+                    std::vector<T>* bin = bin_of(i);
+                    if (bin == nullptr || bin->empty()) {
+                        results[i] = nullptr;
+                        continue;
+                    }
+                    slot = {bin->data(), bin->size(), 0, bin->size(), targets[i], i};
+                    __builtin_prefetch(&slot.data[slot.len / 2]);
+                    return true;
+                }
+                return false;
+            };
+
+            auto finish = [&](const Lookup& slot) {
+                bool base_before = before(slot.data[slot.base].get_key(), slot.target);
+                if constexpr (LESS_EQUAL) {
+                    results[slot.idx] = base_before ? &slot.data[slot.base] : nullptr;
+                } else {
+                    size_t pos = base_before ? slot.base + 1 : slot.base;
+                    results[slot.idx] = pos < slot.size ? &slot.data[pos] : nullptr;
+                }
+            };
+
+            Lookup slots[GROUP_SIZE];
+            size_t active = 0;
+            while (active < GROUP_SIZE && start(slots[active])) {
+                ++active;
+            }
+
+            while (active > 0) {
+                for (size_t j = 0; j < active;) {
+                    auto& slot = slots[j];
+                    if (slot.len > 1) {
+                        size_t half = slot.len / 2;
+                        slot.base = before(slot.data[slot.base + half].get_key(), slot.target)
+                            ? slot.base + half
+                            : slot.base;
+                        slot.len -= half;
+                        __builtin_prefetch(&slot.data[slot.base + slot.len / 2]);
+                        ++j;
+                    } else {
+                        finish(slot);
+                        if (start(slot)) {
+                            ++j;
+                        } else {
+                            /// Fill the gap with the last slot, which is processed next.
+                            slot = slots[--active];
+                        }
+                    }
+                }
+            }
+        }
+    } // namespace detail
+
+    /// Find the last value <= [[targets[i]]] in [[*bins[i]]] for all [[count]] lookups.
+    template <typename T, typename = IsJoinEntry<T>>
+    inline void less_equal_than(std::vector<T>* const* bins, const uint64_t* targets, size_t count, T** results) {
+        detail::search<T, true>([bins](size_t i) { return bins[i]; }, targets, count, results);
+    }
+
+    /// Find the first value >= [[targets[i]]] in [[*bins[i]]] for all [[count]] lookups.
+    template <typename T, typename = IsJoinEntry<T>>
+    inline void greater_equal_than(std::vector<T>* const* bins, const uint64_t* targets, size_t count, T** results) {
+        detail::search<T, false>([bins](size_t i) { return bins[i]; }, targets, count, results);
+    }
+
+    /// Find the last value <= [[targets[i]]] in [[data]] for all [[count]] lookups.
+    template <typename T, typename = IsJoinEntry<T>>
+    inline void less_equal_than(std::vector<T>& data, const uint64_t* targets, size_t count, T** results) {
+        detail::search<T, true>([&data](size_t) { return &data; }, targets, count, results);
+    }
+
+    /// Find the first value >= [[targets[i]]] in [[data]] for all [[count]] lookups.
+    template <typename T, typename = IsJoinEntry<T>>
+    inline void greater_equal_than(std::vector<T>& data, const uint64_t* targets, size_t count, T** results) {
+        detail::search<T, false>([&data](size_t) { return &data; }, targets, count, results);
+    }
+} // namespace Search::Interleaved
+
 #endif // ASOF_JOIN_SEARCHES_HPP
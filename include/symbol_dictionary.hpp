@@ -0,0 +1,57 @@
+#ifndef ASOF_JOIN_SYMBOL_DICTIONARY_HPP
+#define ASOF_JOIN_SYMBOL_DICTIONARY_HPP
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Dense integer id of a stock id. Ids are assigned in insertion order starting at 0.
+using SymbolId = uint32_t;
+
+/// Dictionary which encodes every distinct stock id into a dense [[SymbolId]].
+/// All relations are encoded with the same [[shared()]] dictionary, such that equal stock ids
+/// on both sides of a join map to the same [[SymbolId]] and the joins can key on integers
+/// instead of hashing and comparing strings.
+class SymbolDictionary {
+public:
+    SymbolDictionary() = default;
+
+    SymbolDictionary(const SymbolDictionary& other) = delete;
+    SymbolDictionary& operator=(const SymbolDictionary& other) = delete;
+
+    /// Dictionary shared by all [[Prices]] and [[OrderBook]] relations.
+    static SymbolDictionary& shared() {
+        static SymbolDictionary dictionary;
+        return dictionary;
+    }
+
+    /// Return the id of [[symbol]] and insert it if it does not exist yet.
+    SymbolId encode(std::string_view symbol);
+
+    /// Like [[encode]], but also return a view of the stored symbol, which lives as long as the dictionary.
+    std::pair<SymbolId, std::string_view> intern(std::string_view symbol);
+
+    /// Encode a whole stock id column in parallel.
+    std::vector<SymbolId> encode(const std::vector<std::string>& symbols);
+
+    [[nodiscard]] std::string_view decode(SymbolId id) const;
+
+    /// Number of distinct symbols, i.e. all ids are in [0, size()).
+    [[nodiscard]] size_t size() const;
+
+private:
+    /// Returns the id of [[symbol]] or inserts it. Caller must hold the unique lock.
+    SymbolId insert_unlocked(std::string_view symbol);
+
+    /// Deque keeps the references stable on growth, so [[ids]] can key on views into it.
+    std::deque<std::string> symbols;
+    std::unordered_map<std::string_view, SymbolId> ids;
+    mutable std::shared_mutex mutex;
+};
+
+#endif // ASOF_JOIN_SYMBOL_DICTIONARY_HPP
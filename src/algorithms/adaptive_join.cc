@@ -0,0 +1,187 @@
+#include "asof_join.hpp"
+#include "log.hpp"
+#include "symbol_dictionary.hpp"
+#include <fmt/core.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_reduce.h"
+#include "tbb/task_arena.h"
+
+
+namespace {
+    /// Random accesses of a binary search per probe compared to the sequential accesses of sorting.
+    constexpr double SEARCH_FACTOR = 2.0;
+    /// Minimal fraction of orders before all prices for which filtering them pays off.
+    constexpr double FILTER_MIN_THRESHOLD = 0.05;
+
+    std::pair<uint64_t, uint64_t> min_max(const std::vector<uint64_t>& timestamps) {
+        using MinMax = std::pair<uint64_t, uint64_t>;
+        return tbb::parallel_reduce(tbb::blocked_range<size_t>(0, timestamps.size()),
+            MinMax{UINT64_MAX, 0},
+            [&](const tbb::blocked_range<size_t>& range, MinMax result) {
+                for (size_t i = range.begin(); i < range.end(); ++i) {
+                    result.first = std::min(result.first, timestamps[i]);
+                    result.second = std::max(result.second, timestamps[i]);
+                }
+                return result;
+            },
+            [](MinMax lhs, MinMax rhs) {
+                return MinMax{std::min(lhs.first, rhs.first), std::max(lhs.second, rhs.second)};
+            });
+    }
+
+    size_t sample_stride(size_t size) {
+        return std::max<size_t>(1, size / AdaptiveASOFJoin::SAMPLE_SIZE);
+    }
+
+    /// Cost of partitioning and sorting [[n]] rows into bins of [[bin_size]] rows.
+    double sort_cost(double n, double bin_size) {
+        return n * std::log2(bin_size + 2);
+    }
+
+    /// Cost of searching [[n]] keys in sorted bins of [[bin_size]] rows.
+    double search_cost(double n, double bin_size) {
+        return SEARCH_FACTOR * n * std::log2(bin_size + 2);
+    }
+
+    /// Fraction of the keys in [min_key, max_key] within [[max_lag]] of the range [lower, upper], assuming
+    /// uniformly distributed keys. Only these probes search a bin, see [[may_match_within]].
+    double matching_fraction(uint64_t min_key, uint64_t max_key, uint64_t lower, uint64_t upper, uint64_t max_lag) {
+        if (min_key > max_key || lower > upper) {
+            return 0.0;
+        }
+        lower = lower > max_lag ? lower - max_lag : 0;
+        upper = upper > UINT64_MAX - max_lag ? UINT64_MAX : upper + max_lag;
+        const uint64_t overlap_begin = std::max(min_key, lower);
+        const uint64_t overlap_end = std::min(max_key, upper);
+        if (overlap_begin > overlap_end) {
+            return 0.0;
+        }
+        if (min_key == max_key) {
+            return 1.0;
+        }
+        return static_cast<double>(overlap_end - overlap_begin) / static_cast<double>(max_key - min_key);
+    }
+} // namespace
+
+JoinEstimates AdaptiveASOFJoin::estimate(const Prices& prices, const OrderBook& order_book) {
+    JoinEstimates estimates{};
+    estimates.num_prices = prices.size;
+    estimates.num_orders = order_book.size;
+    std::tie(estimates.min_price_timestamp, estimates.max_price_timestamp) = min_max(prices.timestamps);
+    std::tie(estimates.min_order_timestamp, estimates.max_order_timestamp) = min_max(order_book.timestamps);
+
+    std::vector<bool> seen_stocks(SymbolDictionary::shared().size(), false);
+    auto count_stocks = [&](const std::vector<SymbolId>& symbol_ids) {
+        for (size_t i = 0; i < symbol_ids.size(); i += sample_stride(symbol_ids.size())) {
+            if (!seen_stocks[symbol_ids[i]]) {
+                seen_stocks[symbol_ids[i]] = true;
+                ++estimates.num_stocks;
+            }
+        }
+    };
+    count_stocks(prices.symbol_ids);
+    count_stocks(order_book.symbol_ids);
+
+    size_t num_sampled_orders = 0;
+    size_t num_orders_before_prices = 0;
+    for (size_t i = 0; i < order_book.size; i += sample_stride(order_book.size)) {
+        ++num_sampled_orders;
+        num_orders_before_prices += order_book.timestamps[i] < estimates.min_price_timestamp;
+    }
+    estimates.orders_before_prices = num_sampled_orders == 0
+        ? 0.0
+        : static_cast<double>(num_orders_before_prices) / static_cast<double>(num_sampled_orders);
+
+    return estimates;
+}
+
+AdaptiveASOFJoin::Strategy AdaptiveASOFJoin::choose_strategy(
+        const JoinEstimates& estimates, Comparison comp_type, JoinType join_type,
+        uint64_t max_lag, Materialization materialization) {
+    const double num_prices = static_cast<double>(estimates.num_prices);
+    const double num_orders = static_cast<double>(estimates.num_orders);
+    const double num_stocks = static_cast<double>(std::max<size_t>(1, estimates.num_stocks));
+    const double price_bin_size = num_prices / num_stocks;
+    const double order_bin_size = num_orders / num_stocks;
+
+    /// The merge of a bin is sequential, so fewer stocks than threads leave cores idle.
+    const double merge_parallelism = std::max(
+        1.0, static_cast<double>(tbb::this_task_arena::max_concurrency()) / num_stocks);
+
+    /// With a max lag, probes too far away from all keys of the other relation skip their search.
+    const double matching_orders = num_orders * matching_fraction(
+        estimates.min_order_timestamp, estimates.max_order_timestamp,
+        estimates.min_price_timestamp, estimates.max_price_timestamp, max_lag);
+    const double matching_prices = num_prices * matching_fraction(
+        estimates.min_price_timestamp, estimates.max_price_timestamp,
+        estimates.min_order_timestamp, estimates.max_order_timestamp, max_lag);
+
+    const double right_cost = sort_cost(num_prices, price_bin_size) + search_cost(matching_orders, price_bin_size);
+    const double left_cost = sort_cost(num_orders, order_bin_size) + search_cost(matching_prices, order_bin_size) +
+        num_orders;
+    const double merge_cost = sort_cost(num_prices, price_bin_size) + sort_cost(num_orders, order_bin_size) +
+        (num_prices + num_orders) * merge_parallelism;
+
+    log(fmt::format("Adaptive costs: right {:.3g}, left {:.3g}, sorted merge {:.3g} "
+                    "(matching orders {:.3g}, matching prices {:.3g})",
+                    right_cost, left_cost, merge_cost, matching_orders, matching_prices));
+
+    /// The left partitioning join does not support NEAREST.
+    const bool left_supported = comp_type != NEAREST;
+    Strategy strategy = PARTITION_RIGHT;
+    double best_cost = right_cost;
+    if (left_supported && left_cost < best_cost) {
+        strategy = PARTITION_LEFT;
+        best_cost = left_cost;
+    }
+    if (merge_cost < best_cost) {
+        strategy = PARTITION_SORTED_MERGE;
+    }
+
+    /// The filter min join only implements the default query, but skips all orders before the first price.
+    if (strategy == PARTITION_RIGHT &&
+            comp_type == LESS_EQUAL_THAN && join_type == INNER &&
+            max_lag == NO_MAX_LAG && materialization == EAGER &&
+            estimates.orders_before_prices >= FILTER_MIN_THRESHOLD) {
+        strategy = PARTITION_RIGHT_FILTER_MIN;
+    }
+    return strategy;
+}
+
+void AdaptiveASOFJoin::join() {
+    auto estimates = estimate(prices, order_book);
+    plan = choose_strategy(estimates, comp_type, join_type, max_lag, materialization);
+
+    std::unique_ptr<ASOFJoin> strategy;
+    switch (plan) {
+        case PARTITION_RIGHT:
+            strategy = std::make_unique<PartitioningRightASOFJoin>(
+                prices, order_book, comp_type, join_type, max_lag, materialization);
+            break;
+        case PARTITION_LEFT:
+            strategy = std::make_unique<PartitioningLeftASOFJoin>(
+                prices, order_book, comp_type, join_type, max_lag, materialization);
+            break;
+        case PARTITION_SORTED_MERGE:
+            strategy = std::make_unique<PartitioningSortedMergeJoin>(
+                prices, order_book, comp_type, join_type, max_lag, materialization);
+            break;
+        case PARTITION_RIGHT_FILTER_MIN:
+            strategy = std::make_unique<PartitioningRightFilterMinASOFJoin>(
+                prices, order_book, comp_type, join_type, max_lag, materialization);
+            break;
+    }
+
+    log(fmt::format("Adaptive plan: {} (prices={}, orders={}, stocks={}, "
+                    "price range=[{}, {}], order range=[{}, {}], orders before prices={:.3f})",
+                    strategy->get_strategy_name(), estimates.num_prices, estimates.num_orders,
+                    estimates.num_stocks, estimates.min_price_timestamp, estimates.max_price_timestamp,
+                    estimates.min_order_timestamp, estimates.max_order_timestamp,
+                    estimates.orders_before_prices));
+
+    strategy->join();
+    result = std::move(strategy->result);
+}
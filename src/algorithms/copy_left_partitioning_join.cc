@@ -2,11 +2,11 @@
 #include "timer.hpp"
 #include "log.hpp"
 #include "parallel_multi_map.hpp"
+#include "radix_sort.hpp"
 #include "searches.hpp"
 #include <fmt/format.h>
 #include <unordered_map>
 #include <mutex>
-#include "tbb/parallel_sort.h"
 #include "tbb/parallel_for.h"
 #include "tbb/parallel_for_each.h"
 
@@ -21,7 +21,7 @@ void PartitioningLeftCopyLeftASOFJoin::join() {
 
     //e.startCounters();
     const size_t num_threads = tbb::this_task_arena::max_concurrency();
-    MultiMapTB<LeftEntryCopy> order_book_lookup(order_book.stock_ids, order_book.timestamps);
+    MultiMapTB<LeftEntryCopy, SymbolId> order_book_lookup(order_book.symbol_ids, order_book.timestamps);
 
     log("Partitioning Perf");
     //e.printReport(std::cout, order_book.size);
@@ -30,10 +30,10 @@ void PartitioningLeftCopyLeftASOFJoin::join() {
     //e.startCounters();
     tbb::parallel_for_each(order_book_lookup.begin(), order_book_lookup.end(),
             [&](auto& iter) {
-        tbb::parallel_sort(iter.second.begin(), iter.second.end());
+        radix::sort(iter.second.begin(), iter.second.end());
     });
 
-    std::vector<MultiMapTB<LeftEntryCopy>> order_book_lookups(num_threads, order_book_lookup);
+    std::vector<MultiMapTB<LeftEntryCopy, SymbolId>> order_book_lookups(num_threads, order_book_lookup);
 
     //e.stopCounters();
     log("\n\nSorting Perf:");
@@ -48,12 +48,12 @@ void PartitioningLeftCopyLeftASOFJoin::join() {
         //auto& local_order_book_lookup = order_book_lookups_tbb.local();
 
         for (size_t i = range.begin(); i < range.end(); ++i) {
-            const auto& stock_id = prices.stock_ids[i];
-            if (!local_order_book_lookup.contains(stock_id)) {
+            auto symbol_id = prices.symbol_ids[i];
+            if (!local_order_book_lookup.contains(symbol_id)) {
                 continue;
             }
 
-            auto& partition_bin = local_order_book_lookup[stock_id];
+            auto& partition_bin = local_order_book_lookup[symbol_id];
             auto timestamp = prices.timestamps[i];
             auto* match= Search::Interpolation::greater_equal_than(
                 /* data= */ partition_bin,
@@ -163,6 +163,7 @@ void PartitioningLeftCopyLeftASOFJoin::join() {
                                 /* price= */ prices.prices[last_match->price_idx],
                                 /* order_book_timestamp= */ order_book.timestamps[entry.order_idx],
                                 /* order_book_stock_id= */ order_book.stock_ids[entry.order_idx],
+                                /* order_book_symbol_id= */ order_book.symbol_ids[entry.order_idx],
                                 /* amount= */ order_book.amounts[entry.order_idx]);
                     }
                 }
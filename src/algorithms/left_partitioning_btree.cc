@@ -2,11 +2,11 @@
 #include "timer.hpp"
 #include "log.hpp"
 #include "parallel_multi_map.hpp"
+#include "radix_sort.hpp"
 #include "btree.hpp"
 #include <fmt/format.h>
 #include <unordered_map>
 #include <mutex>
-#include "tbb/parallel_sort.h"
 #include "tbb/parallel_for.h"
 #include "tbb/parallel_for_each.h"
 
@@ -19,7 +19,7 @@ void PartitioningLeftBTreeASOFJoin::join() {
     Timer<milliseconds> timer;
 
     //e.startCounters();
-    MultiMap<LeftEntry> order_book_lookup(order_book.stock_ids, order_book.timestamps);
+    MultiMap<LeftEntry, SymbolId> order_book_lookup(order_book.symbol_ids, order_book.timestamps);
     //e.stopCounters();
     //log("Partitioning Perf");
     //e.printReport(std::cout, order_book.size);
@@ -28,32 +28,33 @@ void PartitioningLeftBTreeASOFJoin::join() {
     //e.startCounters();
     tbb::parallel_for_each(order_book_lookup.begin(), order_book_lookup.end(),
         [&](auto &iter) {
-           tbb::parallel_sort(iter.second.begin(), iter.second.end());
+           radix::sort(iter.second.begin(), iter.second.end());
     });
 
     //e.stopCounters();
     //log("\n\nSorting Perf: ");
 
+    /// The trees index the sorted bins in place, which outlive them.
     using Btree = Btree<LeftEntry>;
-    std::unordered_map<std::string_view, Btree> order_trees(order_book_lookup.size());
+    std::unordered_map<SymbolId, Btree> order_trees(order_book_lookup.size());
     for (auto& iter : order_book_lookup) {
-        order_trees.insert({iter.first, Btree(iter.second)});
+        order_trees.emplace(iter.first, Btree(iter.second));
     }
     //log(fmt::format("Inserting into BTree in {}{}", timer.lap(), timer.unit()));
 
     tbb::parallel_for(tbb::blocked_range<size_t>(0, prices.size, MORSEL_SIZE),
             [&](tbb::blocked_range<size_t>& range) {
         for (size_t i = range.begin(); i < range.end(); ++i) {
-            const auto& stock_id = prices.stock_ids[i];
-            if (!order_book_lookup.contains(stock_id)) {
+            auto symbol_id = prices.symbol_ids[i];
+            if (!order_book_lookup.contains(symbol_id)) {
                 continue;
             }
 
-            if (!order_trees.contains(stock_id)) {
-                std::cout << "Stock id " << stock_id << "in trees but not in index" << std::endl;
+            if (!order_trees.contains(symbol_id)) {
+                std::cout << "Stock id " << prices.stock_ids[i] << "in trees but not in index" << std::endl;
             }
 
-            auto& tree = order_trees[stock_id];
+            auto& tree = order_trees[symbol_id];
             auto& timestamp = prices.timestamps[i];
             auto* match = tree.find_greater_equal_than(timestamp);
             if (match != nullptr) {
@@ -80,48 +81,51 @@ void PartitioningLeftBTreeASOFJoin::join() {
     tbb::parallel_for_each(order_trees.begin(), order_trees.end(),
             [&](auto& iter) {
         Btree& tree = iter.second;
-        const size_t num_thread_chunks = tree.num_leaves();
-        std::vector<LeftEntry*> last_match_per_range(num_thread_chunks);
+        const size_t num_leaves = tree.num_leaves();
+        std::vector<LeftEntry*> last_match_per_leaf(num_leaves);
 
-        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_thread_chunks, 1),
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_leaves),
                 [&](tbb::blocked_range<size_t>& range) {
-            size_t leave_idx = range.begin();
-            auto& leaf_data = tree[leave_idx];
-            LeftEntry* last_match = nullptr;
-            for (size_t i = leaf_data.size(); i != 0; --i) {
-                if (leaf_data[i - 1].matched) {
-                    last_match = &leaf_data[i - 1];
-                    break;
+            for (size_t leaf_idx = range.begin(); leaf_idx < range.end(); ++leaf_idx) {
+                auto leaf_data = tree[leaf_idx];
+                LeftEntry* last_match = nullptr;
+                for (size_t i = leaf_data.size(); i != 0; --i) {
+                    if (leaf_data[i - 1].matched) {
+                        last_match = &leaf_data[i - 1];
+                        break;
+                    }
                 }
+                last_match_per_leaf[leaf_idx] = last_match;
             }
-            last_match_per_range[leave_idx] = last_match;
         });
 
-        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_thread_chunks, 1),
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_leaves),
                 [&](tbb::blocked_range<size_t>& range) {
-            size_t leave_idx = range.begin();
-            auto& leaf_data = tree[leave_idx];
+            /// Only the first leaf of a range looks back, the following ones continue its last match.
             LeftEntry* last_match = nullptr;
-            for (size_t i = leave_idx; i != 0; --i) {
-                if (last_match_per_range[i - 1] != nullptr) {
-                    last_match = last_match_per_range[i - 1];
+            for (size_t i = range.begin(); i != 0; --i) {
+                if (last_match_per_leaf[i - 1] != nullptr) {
+                    last_match = last_match_per_leaf[i - 1];
                     break;
                 }
             }
 
-            for (auto& entry : leaf_data) {
-                if (entry.matched) {
-                    last_match = &entry;
-                }
-
-                if (last_match && last_match->matched) {
-                    result.insert(
-                        /* price_timestamp= */ prices.timestamps[last_match->price_idx],
-                        /* price_stock_id= */ prices.stock_ids[last_match->price_idx],
-                        /* price= */ prices.prices[last_match->price_idx],
-                        /* order_book_timestamp= */ order_book.timestamps[entry.order_idx],
-                        /* order_book_stock_id= */ order_book.stock_ids[entry.order_idx],
-                        /* amount= */ order_book.amounts[entry.order_idx]);
+            for (size_t leaf_idx = range.begin(); leaf_idx < range.end(); ++leaf_idx) {
+                for (auto& entry : tree[leaf_idx]) {
+                    if (entry.matched) {
+                        last_match = &entry;
+                    }
+
+                    if (last_match && last_match->matched) {
+                        result.insert(
+                            /* price_timestamp= */ prices.timestamps[last_match->price_idx],
+                            /* price_stock_id= */ prices.stock_ids[last_match->price_idx],
+                            /* price= */ prices.prices[last_match->price_idx],
+                            /* order_book_timestamp= */ order_book.timestamps[entry.order_idx],
+                            /* order_book_stock_id= */ order_book.stock_ids[entry.order_idx],
+                            /* order_book_symbol_id= */ order_book.symbol_ids[entry.order_idx],
+                            /* amount= */ order_book.amounts[entry.order_idx]);
+                    }
                 }
             }
         });
@@ -2,12 +2,12 @@
 #include "timer.hpp"
 #include "log.hpp"
 #include "parallel_multi_map.hpp"
+#include "radix_sort.hpp"
 #include "searches.hpp"
 #include <algorithm>
 #include <fmt/format.h>
 #include <unordered_map>
 #include <mutex>
-#include "tbb/parallel_sort.h"
 #include "tbb/parallel_for.h"
 #include "tbb/parallel_for_each.h"
 
@@ -21,7 +21,7 @@ void PartitioningLeftFilterMinASOFJoin::join() {
     timer.start();
 
     //e.startCounters();
-    MultiMapTB<LeftEntry> order_book_lookup(order_book.stock_ids, order_book.timestamps);
+    MultiMapTB<LeftEntry, SymbolId> order_book_lookup(order_book.symbol_ids, order_book.timestamps);
     //e.stopCounters();
     log("Partitioning Perf");
     //e.printReport(std::cout, order_book.size);
@@ -30,7 +30,7 @@ void PartitioningLeftFilterMinASOFJoin::join() {
     //e.startCounters();
     tbb::parallel_for_each(order_book_lookup.begin(), order_book_lookup.end(),
             [&](auto& iter) {
-        tbb::parallel_sort(iter.second.begin(), iter.second.end());
+        radix::sort(iter.second.begin(), iter.second.end());
     });
     //e.stopCounters();
     log("\n\nSorting Perf: ");
@@ -59,14 +59,14 @@ void PartitioningLeftFilterMinASOFJoin::join() {
                 continue;
             }
 
-            const auto& stock_id = prices.stock_ids[i];
-            if (!order_book_lookup.contains(stock_id)) {
+            auto symbol_id = prices.symbol_ids[i];
+            if (!order_book_lookup.contains(symbol_id)) {
                 continue;
             }
 
             possible_new_min = true;
 
-            auto& partition_bin = order_book_lookup[stock_id];
+            auto& partition_bin = order_book_lookup[symbol_id];
             auto* match= Search::Interpolation::greater_equal_than(
                 /* data= */ partition_bin,
                 /* target= */ timestamp);
@@ -196,6 +196,7 @@ void PartitioningLeftFilterMinASOFJoin::join() {
                             ///* price= */ prices.prices[last_match->diff_price.load().price_idx],
                             /* order_book_timestamp= */ order_book.timestamps[entry.order_idx],
                             /* order_book_stock_id= */ order_book.stock_ids[entry.order_idx],
+                            /* order_book_symbol_id= */ order_book.symbol_ids[entry.order_idx],
                             /* amount= */ order_book.amounts[entry.order_idx]);
                     }
                 }
@@ -2,11 +2,11 @@
 #include "timer.hpp"
 #include "log.hpp"
 #include "parallel_multi_map.hpp"
-#include "searches.hpp"
+#include "comparison.hpp"
 #include <fmt/format.h>
+#include <algorithm>
 #include <unordered_map>
 #include <mutex>
-#include "tbb/parallel_sort.h"
 #include "tbb/parallel_for.h"
 #include "tbb/parallel_for_each.h"
 
@@ -14,23 +14,43 @@
 // Morsel size is 16384
 #define MORSEL_SIZE (2<<14)
 
+/// Number of rows whose searches are interleaved, such that their bins and results stay cached.
+constexpr size_t INTERLEAVED_BATCH_SIZE = 1024;
+
 void PartitioningLeftASOFJoin::join() {
+    /// Propagating matches through the order bins only works in a single direction.
+    if (comp_type == NEAREST) {
+        throw std::invalid_argument("PartitioningLeftASOFJoin does not support NEAREST");
+    }
+
+    with_comparison(comp_type, [this]<Comparison comp>() {
+        join_impl<comp>();
+    });
+}
+
+template<Comparison comp>
+void PartitioningLeftASOFJoin::join_impl() {
+    using Traits = ComparisonTraits<comp>;
+
     PerfEvent e;
     Timer<milliseconds> timer;
     timer.start();
 
     e.startCounters();
-    MultiMapTB<LeftEntry> order_book_lookup(order_book.stock_ids, order_book.timestamps);
+    MultiMapTB<LeftEntry, SymbolId> order_book_lookup(order_book.symbol_ids, order_book.timestamps);
     e.stopCounters();
     log("Partitioning Perf");
     log(e.getReport(order_book.size));
     log(fmt::format("Partitioning in {}{}", timer.lap(), timer.unit()));
 
     e.startCounters();
-    tbb::parallel_for_each(order_book_lookup.begin(), order_book_lookup.end(),
-            [&](auto& iter) {
-        tbb::parallel_sort(iter.second.begin(), iter.second.end());
-    });
+    /// Heavy bins are split into time ranges, such that skewed stocks are sorted by all threads.
+    order_book_lookup.sort_bins();
+    if (probe_mode() == PROBE_EYTZINGER) {
+        order_book_lookup.build_eytzinger_layouts();
+    } else if (probe_mode() == PROBE_LEARNED) {
+        order_book_lookup.build_learned_layouts();
+    }
     e.stopCounters();
     log("\n\nSorting Perf: ");
     log(e.getReport(order_book.size));
@@ -38,33 +58,113 @@ void PartitioningLeftASOFJoin::join() {
 
     //std::cout << "Size: " << order_book_lookup.total_size_bytes() + order_book.total_size() << std::endl;
 
-    e.startCounters();
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, prices.size, MORSEL_SIZE),
-            [&](tbb::blocked_range<size_t>& range) {
-        for (size_t i = range.begin(); i < range.end(); ++i) {
-            auto& stock_id = prices.stock_ids[i];
-            auto bin_ptr = order_book_lookup.find(stock_id);
-            if (bin_ptr == nullptr) {
-                continue;
-            }
+    auto probe = [&](size_t i, uint64_t timestamp, std::vector<LeftEntry>* bin_ptr, auto&& search) {
+        if (bin_ptr == nullptr ||
+                !may_match_within(bin_ptr->front().timestamp, bin_ptr->back().timestamp, timestamp, max_lag)) {
+            return;
+        }
 
-            auto timestamp = prices.timestamps[i];
-            auto* match = Search::Interpolation::greater_equal_than(
-                /* data= */ *bin_ptr,
-                /* target= */ timestamp);
+        /// Find the closest order this price can be the match of. All orders further
+        /// away in the direction of the comparison inherit it, if no closer price exists.
+        auto* match = search(*bin_ptr, timestamp);
 
-            if (match != nullptr) {
-                uint64_t diff = match->timestamp - timestamp;
-                match->lock_compare_swap_diffs(diff, i);
-                //match->atomic_compare_swap_diffs(diff, i);
+        if (match != nullptr) {
+            uint64_t diff = Traits::lag(timestamp, match->timestamp);
+            /// Prices outside the tolerance of their closest order cannot match any order.
+            if (diff > max_lag) {
+                return;
             }
+            match->lock_compare_swap_diffs(diff, i, Traits::LAST_TIE);
+            //match->atomic_compare_swap_diffs(diff, i);
         }
-    });
+    };
+
+    /// Bins with a search layout are searched on it, all others with the default search.
+    auto probe_with_layouts = [&](auto&& find_layout) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, prices.size, MORSEL_SIZE),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                auto symbol_id = prices.symbol_ids[i];
+                const auto* layout = find_layout(symbol_id);
+                probe(i, prices.timestamps[i], order_book_lookup.find(symbol_id),
+                      [&](std::vector<LeftEntry>& bin, uint64_t target) {
+                    return layout != nullptr
+                        ? layout_search<Traits::MIRRORED>(bin, *layout, target)
+                        : ComparisonTraits<Traits::MIRRORED>::search(bin, target);
+                });
+            }
+        });
+    };
+
+    e.startCounters();
+    if (probe_mode() == PROBE_BATCHED) {
+        /// Every morsel resolves its prices of a stock in ascending time order with one galloping
+        /// merge pass over the bin, instead of an independent search per price.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, prices.size, MORSEL_SIZE),
+                [&](tbb::blocked_range<size_t>& range) {
+            auto probes = sort_probes(prices.symbol_ids, prices.timestamps, range.begin(), range.end());
+            std::vector<LeftEntry>* bin_ptr = nullptr;
+            size_t cursor = 0;
+            for (size_t j = 0; j < probes.size(); ++j) {
+                if (j == 0 || probes[j].symbol_id != probes[j - 1].symbol_id) {
+                    bin_ptr = order_book_lookup.find(probes[j].symbol_id);
+                    cursor = 0;
+                }
+                probe(probes[j].idx, probes[j].timestamp, bin_ptr,
+                      [&](std::vector<LeftEntry>& bin, uint64_t target) {
+                    return merge_search<Traits::MIRRORED>(bin, cursor, target);
+                });
+            }
+        });
+    } else if (probe_mode() == PROBE_INTERLEAVED) {
+        /// The searches of a batch of prices are advanced together, such that their cache misses overlap.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, prices.size, MORSEL_SIZE),
+                [&](tbb::blocked_range<size_t>& range) {
+            std::vector<std::vector<LeftEntry>*> bins(INTERLEAVED_BATCH_SIZE);
+            std::vector<uint64_t> targets(INTERLEAVED_BATCH_SIZE);
+            std::vector<LeftEntry*> matches(INTERLEAVED_BATCH_SIZE);
+            for (size_t begin = range.begin(); begin < range.end(); begin += INTERLEAVED_BATCH_SIZE) {
+                size_t count = std::min(INTERLEAVED_BATCH_SIZE, range.end() - begin);
+                for (size_t k = 0; k < count; ++k) {
+                    auto* bin_ptr = order_book_lookup.find(prices.symbol_ids[begin + k]);
+                    targets[k] = prices.timestamps[begin + k];
+                    /// Bins outside the tolerance window are not searched at all.
+                    bins[k] = bin_ptr != nullptr && may_match_within(
+                        bin_ptr->front().timestamp, bin_ptr->back().timestamp, targets[k], max_lag) ? bin_ptr : nullptr;
+                }
+                interleaved_search<Traits::MIRRORED>(bins.data(), targets.data(), count, matches.data());
+
+                for (size_t k = 0; k < count; ++k) {
+                    /// Bins which cannot contain a match were reset to null by the search.
+                    probe(begin + k, prices.timestamps[begin + k], bins[k],
+                          [&](std::vector<LeftEntry>&, uint64_t) { return matches[k]; });
+                }
+            }
+        });
+    } else if (probe_mode() == PROBE_EYTZINGER) {
+        probe_with_layouts([&](SymbolId symbol_id) { return order_book_lookup.eytzinger_layout(symbol_id); });
+    } else if (probe_mode() == PROBE_LEARNED) {
+        probe_with_layouts([&](SymbolId symbol_id) { return order_book_lookup.learned_layout(symbol_id); });
+    } else {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, prices.size, MORSEL_SIZE),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                probe(i, prices.timestamps[i], order_book_lookup.find(prices.symbol_ids[i]),
+                      [](std::vector<LeftEntry>& bin, uint64_t target) {
+                    return ComparisonTraits<Traits::MIRRORED>::search(bin, target);
+                });
+            }
+        });
+    }
     e.stopCounters();
     log("\n\nBinary Search Perf:");
     log(e.getReport(prices.size));
     log(fmt::format("Binary Search in {}{}", timer.lap(), timer.unit()));
 
+    /// Unmatched orders are emitted while propagating the matches, without an additional pass.
+    const bool left_outer = join_type == LEFT;
+    const bool has_max_lag = max_lag != NO_MAX_LAG;
+
     e.startCounters();
     tbb::parallel_for_each(order_book_lookup.begin(), order_book_lookup.end(),
             [&](auto& iter) {
@@ -72,6 +172,12 @@ void PartitioningLeftASOFJoin::join() {
         const size_t num_thread_chunks = (partition_bin.size() + MORSEL_SIZE - 1) / MORSEL_SIZE;
         std::vector<LeftEntry*> last_match_per_range(num_thread_chunks, nullptr);
 
+        /// Matches are propagated forward through the sorted bin for backward looking comparisons
+        /// and backward for forward looking ones. Chunk positions below are in propagation order.
+        auto entry_at = [&](size_t pos) -> LeftEntry& {
+            return Traits::BACKWARD ? partition_bin[pos] : partition_bin[partition_bin.size() - 1 - pos];
+        };
+
         /// We have to parallel iterate over the number of thread chunks since TBB is not forced to align
         /// each chunk to [[MORSEL_SIZE]] which would make [[range.begin() / MORSEL_SIZE]] a non-correct
         /// chunk position.
@@ -85,8 +191,8 @@ void PartitioningLeftASOFJoin::join() {
                 size_t end = std::min(start + MORSEL_SIZE, partition_bin.size());
 
                 for (size_t i = end; i != start; --i) {
-                    if (partition_bin[i - 1].matched) {
-                        last_match_per_range[chunks_idx] = &partition_bin[i - 1];
+                    if (entry_at(i - 1).matched) {
+                        last_match_per_range[chunks_idx] = &entry_at(i - 1);
                         break;
                     }
                 }
@@ -115,20 +221,30 @@ void PartitioningLeftASOFJoin::join() {
                 //}
 
                 for (size_t i = start; i != end; ++i) {
-                    auto &entry = partition_bin[i];
+                    auto &entry = entry_at(i);
                     if (entry.matched) {
                         last_match = &entry;
                     }
 
-                    if (last_match) {
-                        result.insert(
-                            /* price_timestamp= */ prices.timestamps[last_match->price_idx],
-                            /* price_stock_id= */ prices.stock_ids[last_match->price_idx],
-                            /* price= */ prices.prices[last_match->price_idx],
-                            ///* price= */ prices.prices[last_match->diff_price.load().price_idx],
-                            /* order_book_timestamp= */ order_book.timestamps[entry.order_idx],
-                            /* order_book_stock_id= */ order_book.stock_ids[entry.order_idx],
-                            /* amount= */ order_book.amounts[entry.order_idx]);
+                    /// Only equal timestamps can inherit an exact match.
+                    if constexpr (comp == EQUAL) {
+                        if (last_match && last_match->timestamp != entry.timestamp) {
+                            last_match = nullptr;
+                        }
+                    }
+
+                    /// The closest price is outside the tolerance of this order.
+                    if (has_max_lag && last_match &&
+                            Traits::lag(prices.timestamps[last_match->price_idx], entry.timestamp) > max_lag) {
+                        last_match = nullptr;
+                    }
+
+                    if (!last_match) {
+                        if (left_outer) {
+                            emit_unmatched(entry.order_idx);
+                        }
+                    } else {
+                        emit_match(entry.order_idx, last_match->price_idx);
                     }
                 }
             }
@@ -149,5 +265,5 @@ void PartitioningLeftASOFJoin::join() {
     //}
     //std::cout << "Total contention duration: " << total_duration << std::endl;
 
-    result.finalize();
+    result.finalize(prices, order_book);
 }
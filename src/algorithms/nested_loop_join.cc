@@ -9,7 +9,7 @@ void BaselineASOFJoin::join() {
         size_t min_distance = INT64_MAX;
 
         for (size_t j = 0; j < prices.size; ++j) {
-            if (order_book.stock_ids[i] != prices.stock_ids[j]) {
+            if (order_book.symbol_ids[i] != prices.symbol_ids[j]) {
                 continue;
             }
 
@@ -29,6 +29,7 @@ void BaselineASOFJoin::join() {
                 prices.prices[match_idx],
                 order_book.timestamps[i],
                 order_book.stock_ids[i],
+                order_book.symbol_ids[i],
                 order_book.amounts[i]
             );
         }
@@ -2,10 +2,11 @@
 #include "timer.hpp"
 #include "log.hpp"
 #include "parallel_multi_map.hpp"
+#include "comparison.hpp"
 #include <fmt/format.h>
+#include <algorithm>
 #include <unordered_map>
 #include <mutex>
-#include "tbb/parallel_sort.h"
 #include "tbb/parallel_for_each.h"
 
 
@@ -13,83 +14,141 @@
 #define MORSEL_SIZE (2<<14)
 
 void PartitioningSortedMergeJoin::join() {
+    with_comparison(comp_type, [this]<Comparison comp>() {
+        join_impl<comp>();
+    });
+}
+
+template<Comparison comp>
+void PartitioningSortedMergeJoin::join_impl() {
     PerfEvent e;
     Timer<milliseconds> timer;
     timer.start();
 
     e.startCounters();
-    MultiMapTB<RightEntry> prices_index(prices.stock_ids, prices.timestamps);
+    MultiMapTB<RightEntry, SymbolId> prices_index(prices.symbol_ids, prices.timestamps);
     log(fmt::format("Left Partitioning in {}{}", timer.lap(), timer.unit()));
 
-    MultiMapTB<RightEntry> order_book_index(order_book.stock_ids, order_book.timestamps);
+    MultiMapTB<RightEntry, SymbolId> order_book_index(order_book.symbol_ids, order_book.timestamps);
     log(fmt::format("Right Partitioning in {}{}", timer.lap(), timer.unit()));
     log("\n\nPartitioning Perf");
     e.stopCounters();
     log(e.getReport(order_book.size + prices.size));
 
     e.startCounters();
-    tbb::parallel_for_each(prices_index.begin(), prices_index.end(),
-            [&](auto& iter) {
-        tbb::parallel_sort(iter.second.begin(), iter.second.end());
-    });
-
-    tbb::parallel_for_each(order_book_index.begin(), order_book_index.end(),
-            [&](auto& iter) {
-        tbb::parallel_sort(iter.second.begin(), iter.second.end());
-    });
+    prices_index.sort_bins();
+    /// Heavy order bins are split into time ranges which are merged independently.
+    auto order_ranges = order_book_index.sort_bins();
     e.stopCounters();
     log("\n\nSorting Perf");
     log(e.getReport(order_book.size + prices.size));
     log(fmt::format("Sorting in {}{}", timer.lap(), timer.unit()));
 
-    e.startCounters();
-    tbb::parallel_for_each(order_book_index.begin(), order_book_index.end(),
-            [&](auto& iter) {
-        std::vector<RightEntry>& orders_bin = order_book_index[iter.first];
+    const bool left_outer = join_type == LEFT;
 
-        if (!prices_index.contains(iter.first)) {
+    e.startCounters();
+    tbb::parallel_for_each(order_ranges.begin(), order_ranges.end(),
+            [&](auto& range) {
+        std::vector<RightEntry>& orders_bin = order_book_index[range.key];
+
+        auto insert_unmatched = [&](size_t l) {
+            emit_unmatched(orders_bin[l].idx);
+        };
+
+        if (!prices_index.contains(range.key)) {
+            if (left_outer) {
+                for (size_t l = range.begin; l < range.end; ++l) {
+                    insert_unmatched(l);
+                }
+            }
             return;
         }
-        std::vector<RightEntry>& prices_bin = prices_index[iter.first];
-
-        size_t l = 0;
-        size_t r = 0;
+        std::vector<RightEntry>& prices_bin = prices_index[range.key];
+
+        size_t l = range.begin;
+        /// Ranges of a split bin start the merge at the last price before their first order
+        /// (or the first one after it, when looking forward) instead of the start of the bin.
+        size_t r = std::lower_bound(prices_bin.begin(), prices_bin.end(), orders_bin[l].timestamp,
+            [](const RightEntry& entry, uint64_t timestamp) {
+                return entry.timestamp < timestamp;
+            }) - prices_bin.begin();
+        if (ComparisonTraits<comp>::BACKWARD && r > 0) {
+            --r;
+        }
 
-        while(l < orders_bin.size() && r < prices_bin.size()) {
+        while(l < range.end && r < prices_bin.size()) {
             bool found_match = false;
             size_t last_valid_r = r;
 
-            while(r < prices_bin.size() &&
-                prices_bin[r].timestamp <= orders_bin[l].timestamp) {
-                found_match = true;
+            if constexpr (comp == NEAREST) {
+                /// Advance to the last price before the order and compare it with its successor.
+                while(r < prices_bin.size() && prices_bin[r].timestamp <= orders_bin[l].timestamp) {
+                    found_match = true;
+                    last_valid_r = r;
+                    ++r;
+                }
+            } else if constexpr (ComparisonTraits<comp>::BACKWARD) {
+                /// Advance to the last matching price.
+                while(r < prices_bin.size() &&
+                    ComparisonTraits<comp>::matches(prices_bin[r].timestamp, orders_bin[l].timestamp)) {
+                    found_match = true;
+                    last_valid_r = r;
+                    ++r;
+                }
+            } else {
+                /// Skip all prices before the first matching one.
+                while(r < prices_bin.size() &&
+                    prices_bin[r].timestamp <= orders_bin[l].timestamp &&
+                    !ComparisonTraits<comp>::matches(prices_bin[r].timestamp, orders_bin[l].timestamp)) {
+                    ++r;
+                }
+                found_match = r < prices_bin.size() &&
+                    ComparisonTraits<comp>::matches(prices_bin[r].timestamp, orders_bin[l].timestamp);
                 last_valid_r = r;
-                ++r;
+                if constexpr (ComparisonTraits<comp>::LAST_TIE) {
+                    /// Advance to the last of the equal prices.
+                    while (found_match && last_valid_r + 1 < prices_bin.size() &&
+                           prices_bin[last_valid_r + 1].timestamp == prices_bin[last_valid_r].timestamp) {
+                        ++last_valid_r;
+                    }
+                }
+            }
+
+            size_t match_r = last_valid_r;
+            if constexpr (comp == NEAREST) {
+                /// [[r]] is the first price after the order. On equal distance the earlier price is kept.
+                if (r < prices_bin.size() && (!found_match ||
+                        prices_bin[r].timestamp - orders_bin[l].timestamp <
+                        orders_bin[l].timestamp - prices_bin[last_valid_r].timestamp)) {
+                    found_match = true;
+                    match_r = r;
+                }
+            }
+
+            if (found_match && ComparisonTraits<comp>::lag(
+                    prices_bin[match_r].timestamp, orders_bin[l].timestamp) > max_lag) {
+                found_match = false;
             }
 
             if (found_match) {
-                size_t order_idx = orders_bin[l].idx;
-                size_t price_idx = prices_bin[last_valid_r].idx;
-
-                result.insert(
-                    /* price_timestamp= */ prices.timestamps[price_idx],
-                    /* price_stock_id= */ prices.stock_ids[price_idx],
-                    /* price= */ prices.prices[price_idx],
-                    /* order_book_timestamp= */ order_book.timestamps[order_idx],
-                    /* order_book_stock_id= */ order_book.stock_ids[order_idx],
-                    /* amount= */ order_book.amounts[order_idx]);
+                emit_match(orders_bin[l].idx, prices_bin[match_r].idx);
+            } else if (left_outer) {
+                insert_unmatched(l);
             }
 
             ++l;
             r = last_valid_r;
         }
 
-        orders_bin.clear();
-        prices_bin.clear();
+        /// All prices are consumed, so the remaining orders have no match.
+        for (; left_outer && l < range.end; ++l) {
+            insert_unmatched(l);
+        }
     });
     e.stopCounters();
     log("Sorted Merge Join Perf");
     log(e.getReport(order_book.size + prices.size));
     log(fmt::format("Partitioned Sorted Merge join in {}{}", timer.lap(), timer.unit()));
 
-    result.finalize();
+    result.finalize(prices, order_book);
 }
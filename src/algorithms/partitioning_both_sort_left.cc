@@ -4,6 +4,7 @@
 #include "log.hpp"
 #include "util.hpp"
 #include "parallel_multi_map.hpp"
+#include "radix_sort.hpp"
 #include <fmt/format.h>
 #include <algorithm>
 #include <unordered_map>
@@ -22,10 +23,10 @@ void PartitioningBothSortLeftASOFJoin::join() {
     timer.start();
 
     //e.startCounters();
-    MultiMapTB<LeftEntry> order_book_lookup(order_book.stock_ids, order_book.timestamps);
+    MultiMapTB<LeftEntry, SymbolId> order_book_lookup(order_book.symbol_ids, order_book.timestamps);
     log(fmt::format("Right Partitioning in {}{}", timer.lap(), timer.unit()));
 
-    //MultiMapTB<RightEntry> prices_lookup(prices.stock_ids, prices.timestamps);
+    //MultiMapTB<RightEntry, SymbolId> prices_lookup(prices.symbol_ids, prices.timestamps);
     //log(fmt::format("Left Partitioning in {}{}", timer.lap(), timer.unit()));
     //e.stopCounters();
     //log("Partitioning Perf");
@@ -34,7 +35,7 @@ void PartitioningBothSortLeftASOFJoin::join() {
     //e.startCounters();
     tbb::parallel_for_each(order_book_lookup.begin(), order_book_lookup.end(),
             [&](auto& iter) {
-        tbb::parallel_sort(iter.second.begin(), iter.second.end());
+        radix::sort(iter.second.begin(), iter.second.end());
     });
 
     //e.stopCounters();
@@ -46,7 +47,6 @@ void PartitioningBothSortLeftASOFJoin::join() {
 
     const uint32_t num_partitions = 128;
     const uint32_t mask = num_partitions - 1;
-    std::hash<std::string> hash;
 
     tbb::parallel_for(tbb::blocked_range<size_t>(0, prices.size, MORSEL_SIZE),
             [&](tbb::blocked_range<size_t>& range) {
@@ -54,7 +54,7 @@ void PartitioningBothSortLeftASOFJoin::join() {
         /// binary searches on the same data after each other.
         std::vector<TupleBuffer<RightEntry>> partitions(num_partitions);
         for (size_t i = range.begin(); i < range.end(); ++i) {
-            size_t pos = hash(prices.stock_ids[i]) & mask;
+            size_t pos = prices.symbol_ids[i] & mask;
             partitions[pos].emplace_back(
                 /* timestamp= */ prices.timestamps[i],
                 /* idx= */ i);
@@ -66,12 +66,12 @@ void PartitioningBothSortLeftASOFJoin::join() {
             //tbb::parallel_sort(partition.begin(), partition.end());
 
             for (auto& entry : partition) {
-                const auto& stock_id = prices.stock_ids[entry.idx];
-                if (!order_book_lookup.contains(stock_id)) {
+                auto symbol_id = prices.symbol_ids[entry.idx];
+                if (!order_book_lookup.contains(symbol_id)) {
                     continue;
                 }
 
-                auto& partition_bin = order_book_lookup[stock_id];
+                auto& partition_bin = order_book_lookup[symbol_id];
                 auto timestamp = entry.timestamp;
                 auto* match = Search::Interpolation::greater_equal_than(
                     /* data= */ partition_bin,
@@ -159,6 +159,7 @@ void PartitioningBothSortLeftASOFJoin::join() {
                                 /* price= */ prices.prices[last_match->price_idx],
                                 /* order_book_timestamp= */ order_book.timestamps[entry.order_idx],
                                 /* order_book_stock_id= */ order_book.stock_ids[entry.order_idx],
+                                /* order_book_symbol_id= */ order_book.symbol_ids[entry.order_idx],
                                 /* amount= */ order_book.amounts[entry.order_idx]);
                     }
                 }
@@ -2,6 +2,7 @@
 #include "timer.hpp"
 #include "log.hpp"
 #include "parallel_multi_map.hpp"
+#include "radix_sort.hpp"
 #include "searches.hpp"
 #include <fmt/core.h>
 #include <algorithm>
@@ -9,7 +10,6 @@
 #include <mutex>
 #include "tbb/parallel_for.h"
 #include "tbb/parallel_for_each.h"
-#include "tbb/parallel_sort.h"
 
 
 // Morsel size is 16384
@@ -21,7 +21,7 @@ void PartitioningRightFilterMinASOFJoin::join() {
     PerfEvent e;
 
     e.startCounters();
-    MultiMapTB<RightEntry> prices_lookup(prices.stock_ids, prices.timestamps);
+    MultiMapTB<RightEntry, SymbolId> prices_lookup(prices.symbol_ids, prices.timestamps);
     e.stopCounters();
     log("Partitioning Perf");
     log(e.getReport(prices.size));
@@ -30,7 +30,7 @@ void PartitioningRightFilterMinASOFJoin::join() {
     e.startCounters();
     tbb::parallel_for_each(prices_lookup.begin(), prices_lookup.end(),
             [&](auto& iter) {
-        tbb::parallel_sort(iter.second.begin(), iter.second.end());
+        radix::sort(iter.second.begin(), iter.second.end());
     });
     log(fmt::format("Sorting in {}{}", timer.lap(), timer.unit()));
     e.stopCounters();
@@ -50,8 +50,8 @@ void PartitioningRightFilterMinASOFJoin::join() {
     tbb::parallel_for(tbb::blocked_range<size_t>(0, order_book.size, MORSEL_SIZE),
             [&](tbb::blocked_range<size_t>& range) {
         for (size_t i = range.begin(); i < range.end(); ++i) {
-            auto& stock_id = order_book.stock_ids[i];
-            if (!prices_lookup.contains(stock_id)) {
+            auto symbol_id = order_book.symbol_ids[i];
+            if (!prices_lookup.contains(symbol_id)) {
                continue;
             }
 
@@ -62,7 +62,7 @@ void PartitioningRightFilterMinASOFJoin::join() {
                 continue;
             }
 
-            auto& partition_bin = prices_lookup[stock_id];
+            auto& partition_bin = prices_lookup[symbol_id];
             auto* match = Search::Interpolation::less_equal_than(
                 /* data= */ partition_bin,
                 /* target= */ timestamp);
@@ -70,10 +70,11 @@ void PartitioningRightFilterMinASOFJoin::join() {
             if (match != nullptr) {
                 result.insert(
                     /* price_timestamp= */match->timestamp,
-                    /* price_stock_id= */ stock_id,
+                    /* price_stock_id= */ prices.stock_ids[match->idx],
                     /* price= */ prices.prices[match->idx],
                     /* order_book_timestamp= */ timestamp,
                     /* order_book_stock_id= */ order_book.stock_ids[i],
+                    /* order_book_symbol_id= */ order_book.symbol_ids[i],
                     /* amount= */ order_book.amounts[i]);
             }
         }
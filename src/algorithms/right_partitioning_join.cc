@@ -2,36 +2,50 @@
 #include "timer.hpp"
 #include "log.hpp"
 #include "parallel_multi_map.hpp"
-#include "searches.hpp"
+#include "comparison.hpp"
 #include <fmt/core.h>
 #include <algorithm>
 #include <unordered_map>
 #include <mutex>
 #include "tbb/parallel_for.h"
 #include "tbb/parallel_for_each.h"
-#include "tbb/parallel_sort.h"
 
 
 // Morsel size is 16384
 #define MORSEL_SIZE (2<<14)
 
+/// Number of rows whose searches are interleaved, such that their bins and results stay cached.
+constexpr size_t INTERLEAVED_BATCH_SIZE = 1024;
+
 void PartitioningRightASOFJoin::join() {
+    with_comparison(comp_type, [this]<Comparison comp>() {
+        join_impl<comp>();
+    });
+}
+
+template<Comparison comp>
+void PartitioningRightASOFJoin::join_impl() {
     Timer<milliseconds> timer;
     timer.start();
     PerfEvent e;
 
     e.startCounters();
-    MultiMapTB<RightEntry> prices_lookup(prices.stock_ids, prices.timestamps);
+    MultiMapTB<RightEntry, SymbolId> prices_lookup(prices.symbol_ids, prices.timestamps);
     e.stopCounters();
     log("Partitioning Perf");
     log(e.getReport(prices.size));
     log(fmt::format("Partitioning in {}{}", timer.lap(), timer.unit()));
 
     e.startCounters();
-    tbb::parallel_for_each(prices_lookup.begin(), prices_lookup.end(),
-            [&](auto& iter) {
-        tbb::parallel_sort(iter.second.begin(), iter.second.end());
-    });
+    /// Heavy bins are split into time ranges, such that skewed stocks are sorted by all threads.
+    prices_lookup.sort_bins();
+    if (probe_mode() == PROBE_EYTZINGER) {
+        prices_lookup.build_eytzinger_layouts();
+    } else if (probe_mode() == PROBE_KARY) {
+        prices_lookup.build_kary_layouts();
+    } else if (probe_mode() == PROBE_LEARNED) {
+        prices_lookup.build_learned_layouts();
+    }
     e.stopCounters();
     log("\n\nSorting Perf: ");
     log(e.getReport(prices.size));
@@ -39,36 +53,112 @@ void PartitioningRightASOFJoin::join() {
 
     //std::cout << "Size: " << prices_lookup.total_size_bytes() + prices.total_size() << std::endl;
 
-    e.startCounters();
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, order_book.size, MORSEL_SIZE),
-            [&](tbb::blocked_range<size_t>& range) {
-        for (size_t i = range.begin(); i < range.end(); ++i) {
-            auto& stock_id = order_book.stock_ids[i];
-            auto bin_ptr = prices_lookup.find(stock_id);
-            if (bin_ptr == nullptr) {
-                continue;
+    const bool left_outer = join_type == LEFT;
+
+    auto probe = [&](size_t i, uint64_t timestamp, std::vector<RightEntry>* bin_ptr, auto&& search) {
+        /// Only search bins which overlap the tolerance window around the order.
+        RightEntry* match = nullptr;
+        if (bin_ptr != nullptr && may_match_within(
+                bin_ptr->front().timestamp, bin_ptr->back().timestamp, timestamp, max_lag)) {
+            match = search(*bin_ptr, timestamp);
+
+            if (match != nullptr && ComparisonTraits<comp>::lag(match->timestamp, timestamp) > max_lag) {
+                match = nullptr;
             }
+        }
 
-            auto timestamp = order_book.timestamps[i];
-            auto* match = Search::Interpolation::less_equal_than(
-                    /* data= */ *bin_ptr,
-                    /* target= */ timestamp);
-
-            if (match != nullptr) {
-                result.insert(
-                    /* price_timestamp= */match->timestamp,
-                    /* price_stock_id= */ stock_id,
-                    /* price= */ prices.prices[match->idx],
-                    /* order_book_timestamp= */ timestamp,
-                    /* order_book_stock_id= */ order_book.stock_ids[i],
-                    /* amount= */ order_book.amounts[i]);
+        if (match == nullptr) {
+            if (left_outer) {
+                emit_unmatched(i);
             }
+        } else {
+            emit_match(i, match->idx);
         }
-    });
+    };
+
+    /// Bins with a search layout are searched on it, all others with the default search.
+    auto probe_with_layouts = [&](auto&& find_layout) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, order_book.size, MORSEL_SIZE),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                auto symbol_id = order_book.symbol_ids[i];
+                const auto* layout = find_layout(symbol_id);
+                probe(i, order_book.timestamps[i], prices_lookup.find(symbol_id),
+                      [&](std::vector<RightEntry>& bin, uint64_t target) {
+                    return layout != nullptr
+                        ? layout_search<comp>(bin, *layout, target)
+                        : ComparisonTraits<comp>::search(bin, target);
+                });
+            }
+        });
+    };
+
+    e.startCounters();
+    if (probe_mode() == PROBE_BATCHED) {
+        /// Every morsel resolves its orders of a stock in ascending time order with one galloping
+        /// merge pass over the bin, instead of an independent search per order.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, order_book.size, MORSEL_SIZE),
+                [&](tbb::blocked_range<size_t>& range) {
+            auto probes = sort_probes(order_book.symbol_ids, order_book.timestamps, range.begin(), range.end());
+            std::vector<RightEntry>* bin_ptr = nullptr;
+            size_t cursor = 0;
+            for (size_t j = 0; j < probes.size(); ++j) {
+                if (j == 0 || probes[j].symbol_id != probes[j - 1].symbol_id) {
+                    bin_ptr = prices_lookup.find(probes[j].symbol_id);
+                    cursor = 0;
+                }
+                probe(probes[j].idx, probes[j].timestamp, bin_ptr,
+                      [&](std::vector<RightEntry>& bin, uint64_t target) {
+                    return merge_search<comp>(bin, cursor, target);
+                });
+            }
+        });
+    } else if (probe_mode() == PROBE_INTERLEAVED) {
+        /// The searches of a batch of orders are advanced together, such that their cache misses overlap.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, order_book.size, MORSEL_SIZE),
+                [&](tbb::blocked_range<size_t>& range) {
+            std::vector<std::vector<RightEntry>*> bins(INTERLEAVED_BATCH_SIZE);
+            std::vector<uint64_t> targets(INTERLEAVED_BATCH_SIZE);
+            std::vector<RightEntry*> matches(INTERLEAVED_BATCH_SIZE);
+            for (size_t begin = range.begin(); begin < range.end(); begin += INTERLEAVED_BATCH_SIZE) {
+                size_t count = std::min(INTERLEAVED_BATCH_SIZE, range.end() - begin);
+                for (size_t k = 0; k < count; ++k) {
+                    auto* bin_ptr = prices_lookup.find(order_book.symbol_ids[begin + k]);
+                    targets[k] = order_book.timestamps[begin + k];
+                    /// Bins outside the tolerance window are not searched at all.
+                    bins[k] = bin_ptr != nullptr && may_match_within(
+                        bin_ptr->front().timestamp, bin_ptr->back().timestamp, targets[k], max_lag) ? bin_ptr : nullptr;
+                }
+                interleaved_search<comp>(bins.data(), targets.data(), count, matches.data());
+
+                for (size_t k = 0; k < count; ++k) {
+                    /// Bins which cannot contain a match were reset to null by the search.
+                    probe(begin + k, order_book.timestamps[begin + k], bins[k],
+                          [&](std::vector<RightEntry>&, uint64_t) { return matches[k]; });
+                }
+            }
+        });
+    } else if (probe_mode() == PROBE_EYTZINGER) {
+        probe_with_layouts([&](SymbolId symbol_id) { return prices_lookup.eytzinger_layout(symbol_id); });
+    } else if (probe_mode() == PROBE_KARY) {
+        probe_with_layouts([&](SymbolId symbol_id) { return prices_lookup.kary_layout(symbol_id); });
+    } else if (probe_mode() == PROBE_LEARNED) {
+        probe_with_layouts([&](SymbolId symbol_id) { return prices_lookup.learned_layout(symbol_id); });
+    } else {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, order_book.size, MORSEL_SIZE),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                probe(i, order_book.timestamps[i], prices_lookup.find(order_book.symbol_ids[i]),
+                      [](std::vector<RightEntry>& bin, uint64_t target) {
+                    return ComparisonTraits<comp>::search(bin, target);
+                });
+            }
+        });
+    }
     e.stopCounters();
     log("\n\nBinary Search Perf: ");
     log(e.getReport(prices.size));
     log(fmt::format("Binary Search in {}{}", timer.lap(), timer.unit()));
 
-    result.finalize();
+    result.finalize(prices, order_book);
 }
\ No newline at end of file
@@ -15,8 +15,8 @@ void SortingASOFJoin::join() {
     for (size_t i = 0; i < prices.size; ++i) { prices_indices[i] = i; }
     tbb::parallel_sort(prices_indices.begin(), prices_indices.end(),
         [&](size_t i, size_t j) {
-        return prices.stock_ids[i] != prices.stock_ids[j]
-            ? prices.stock_ids[i] < prices.stock_ids[j]
+        return prices.symbol_ids[i] != prices.symbol_ids[j]
+            ? prices.symbol_ids[i] < prices.symbol_ids[j]
             : prices.timestamps[i] < prices.timestamps[j];
     });
 
@@ -26,8 +26,8 @@ void SortingASOFJoin::join() {
     for (size_t i = 0; i < order_book.size; ++i) { order_book_indices[i] = i; }
     tbb::parallel_sort(order_book_indices.begin(), order_book_indices.end(),
         [&](size_t i, size_t j) {
-        return order_book.stock_ids[i] != order_book.stock_ids[j]
-            ? order_book.stock_ids[i] < order_book.stock_ids[j]
+        return order_book.symbol_ids[i] != order_book.symbol_ids[j]
+            ? order_book.symbol_ids[i] < order_book.symbol_ids[j]
             : order_book.timestamps[i] < order_book.timestamps[j];
     });
 
@@ -38,20 +38,20 @@ void SortingASOFJoin::join() {
         size_t price_idx = prices_indices[i];
         size_t order_book_idx = order_book_indices[j];
 
-        if (prices.stock_ids[price_idx] < order_book.stock_ids[order_book_idx]) {
+        if (prices.symbol_ids[price_idx] < order_book.symbol_ids[order_book_idx]) {
             ++i;
             continue;
-        } else if (prices.stock_ids[price_idx] > order_book.stock_ids[order_book_idx]) {
+        } else if (prices.symbol_ids[price_idx] > order_book.symbol_ids[order_book_idx]) {
             ++j;
             continue;
         }
 
-        assert(prices.stock_ids[price_idx] == order_book.stock_ids[order_book_idx]);
+        assert(prices.symbol_ids[price_idx] == order_book.symbol_ids[order_book_idx]);
 
         size_t last_match = i;
         bool found_match = false;
         while (i < prices.size &&
-            prices.stock_ids[price_idx] == order_book.stock_ids[order_book_idx] &&
+            prices.symbol_ids[price_idx] == order_book.symbol_ids[order_book_idx] &&
             prices.timestamps[price_idx] <= order_book.timestamps[order_book_idx]) {
 
             last_match = i;
@@ -69,6 +69,7 @@ void SortingASOFJoin::join() {
                 prices.prices[price_idx],
                 order_book.timestamps[order_book_idx],
                 order_book.stock_ids[order_book_idx],
+                order_book.symbol_ids[order_book_idx],
                 order_book.amounts[order_book_idx]
             );
         }
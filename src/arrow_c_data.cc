@@ -0,0 +1,294 @@
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "arrow_c_data.hpp"
+
+#include "tbb/parallel_for.h"
+
+
+namespace {
+    /// Columns of an imported or exported relation.
+    constexpr int64_t NUM_COLUMNS = 3;
+    /// Columns of an exported result, which is the maximal number of exported columns.
+    constexpr int64_t NUM_RESULT_COLUMNS = 6;
+
+    /// Child column of an exported struct array.
+    struct ExportColumn {
+        std::string name;
+        /// Null for the stock id column, which uses the utf8 buffers of [[ExportData]].
+        const uint64_t* values;
+        const uint8_t* validity = nullptr;
+        int64_t null_count = 0;
+    };
+
+    /// Owner of all buffers and child structs of an exported array and its schema.
+    /// Every exported struct holds a reference to it in its private data, such that
+    /// children which are moved out of their parent stay valid after the parent is released.
+    struct ExportData {
+        ResultColumns owned_result;
+        std::vector<int64_t> stock_id_offsets;
+        std::string stock_id_data;
+        std::vector<uint8_t> price_validity;
+
+        const void* struct_buffers[1] = {nullptr};
+        const void* child_buffers[NUM_RESULT_COLUMNS][3] = {};
+        ArrowArray child_arrays[NUM_RESULT_COLUMNS] = {};
+        ArrowArray* child_array_pointers[NUM_RESULT_COLUMNS] = {};
+
+        std::string names[NUM_RESULT_COLUMNS];
+        ArrowSchema child_schemas[NUM_RESULT_COLUMNS] = {};
+        ArrowSchema* child_schema_pointers[NUM_RESULT_COLUMNS] = {};
+    };
+
+    using ExportDataPtr = std::shared_ptr<ExportData>;
+
+    template<typename T>
+    void release_export(T* object) {
+        for (int64_t i = 0; i < object->n_children; ++i) {
+            auto* child = object->children[i];
+            if (child->release) {
+                child->release(child);
+            }
+        }
+        delete static_cast<ExportDataPtr*>(object->private_data);
+        object->release = nullptr;
+    }
+
+    /// Convert the stock ids into a large utf8 column, i.e. int64 offsets followed by the bytes.
+    template<typename StockIds>
+    void build_stock_id_column(const StockIds& stock_ids, size_t num_rows, ExportData& data) {
+        data.stock_id_offsets.resize(num_rows + 1);
+        data.stock_id_offsets[0] = 0;
+        for (size_t i = 0; i < num_rows; ++i) {
+            data.stock_id_offsets[i + 1] = data.stock_id_offsets[i] + static_cast<int64_t>(stock_ids[i].size());
+        }
+
+        data.stock_id_data.resize(data.stock_id_offsets[num_rows]);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_rows),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                std::memcpy(data.stock_id_data.data() + data.stock_id_offsets[i],
+                            stock_ids[i].data(), stock_ids[i].size());
+            }
+        });
+    }
+
+    /// Fill [[array]] and [[schema]] with a struct array of [[columns]].
+    /// The buffers of the columns must outlive the export or be owned by [[data]].
+    void export_columns(const ExportDataPtr& data, const std::vector<ExportColumn>& columns, size_t num_rows,
+                        ArrowArray* array, ArrowSchema* schema) {
+        const auto num_columns = static_cast<int64_t>(columns.size());
+        for (int64_t i = 0; i < num_columns; ++i) {
+            const auto& column = columns[i];
+            const bool is_stock_id = column.values == nullptr;
+            data->names[i] = column.name;
+            data->child_buffers[i][0] = column.validity;
+            if (is_stock_id) {
+                data->child_buffers[i][1] = data->stock_id_offsets.data();
+                data->child_buffers[i][2] = data->stock_id_data.data();
+            } else {
+                data->child_buffers[i][1] = column.values;
+            }
+
+            auto& child_array = data->child_arrays[i];
+            child_array.length = static_cast<int64_t>(num_rows);
+            child_array.null_count = column.null_count;
+            child_array.offset = 0;
+            child_array.n_buffers = is_stock_id ? 3 : 2;
+            child_array.n_children = 0;
+            child_array.buffers = data->child_buffers[i];
+            child_array.children = nullptr;
+            child_array.dictionary = nullptr;
+            child_array.release = release_export<ArrowArray>;
+            child_array.private_data = new ExportDataPtr(data);
+            data->child_array_pointers[i] = &child_array;
+
+            auto& child_schema = data->child_schemas[i];
+            child_schema.format = is_stock_id ? "U" : "L";
+            child_schema.name = data->names[i].c_str();
+            child_schema.metadata = nullptr;
+            child_schema.flags = column.null_count > 0 ? ARROW_FLAG_NULLABLE : 0;
+            child_schema.n_children = 0;
+            child_schema.children = nullptr;
+            child_schema.dictionary = nullptr;
+            child_schema.release = release_export<ArrowSchema>;
+            child_schema.private_data = new ExportDataPtr(data);
+            data->child_schema_pointers[i] = &child_schema;
+        }
+
+        array->length = static_cast<int64_t>(num_rows);
+        array->null_count = 0;
+        array->offset = 0;
+        array->n_buffers = 1;
+        array->n_children = num_columns;
+        array->buffers = data->struct_buffers;
+        array->children = data->child_array_pointers;
+        array->dictionary = nullptr;
+        array->release = release_export<ArrowArray>;
+        array->private_data = new ExportDataPtr(data);
+
+        schema->format = "+s";
+        schema->name = "";
+        schema->metadata = nullptr;
+        schema->flags = 0;
+        schema->n_children = num_columns;
+        schema->children = data->child_schema_pointers;
+        schema->dictionary = nullptr;
+        schema->release = release_export<ArrowSchema>;
+        schema->private_data = new ExportDataPtr(data);
+    }
+
+    void check_no_nulls(const ArrowArray& array, std::string_view column) {
+        if (array.null_count != 0 && array.n_buffers > 0 && array.buffers[0] != nullptr) {
+            throw std::runtime_error("Arrow column " + std::string(column) + " must not contain nulls");
+        }
+    }
+
+    /// Return the data of a 64 bit integer (or timestamp) column.
+    const uint64_t* integer_column(const ArrowArray& array, const ArrowSchema& schema,
+                                   int64_t offset, std::string_view column) {
+        std::string_view format = schema.format;
+        if ((format != "L" && format != "l" && !format.starts_with("ts")) || array.n_buffers != 2) {
+            throw std::runtime_error("Arrow column " + std::string(column) +
+                " must be a 64 bit integer but has format " + std::string(format));
+        }
+        check_no_nulls(array, column);
+        return static_cast<const uint64_t*>(array.buffers[1]) + array.offset + offset;
+    }
+} // namespace
+
+arrow_c::ImportedRelation::ImportedRelation(ArrowArray* in_array, ArrowSchema* in_schema):
+        array(*in_array), schema(*in_schema) {
+    in_array->release = nullptr;
+    in_schema->release = nullptr;
+
+    try {
+        if (std::string_view(schema.format) != "+s" ||
+                schema.n_children != NUM_COLUMNS || array.n_children != NUM_COLUMNS) {
+            throw std::runtime_error(
+                "Arrow array must be a struct of <timestamp, stock_id, value> but has format " +
+                std::string(schema.format));
+        }
+        check_no_nulls(array, "struct");
+
+        size = static_cast<size_t>(array.length);
+        timestamps_data = integer_column(*array.children[0], *schema.children[0], array.offset, "timestamp");
+        values_data = integer_column(*array.children[2], *schema.children[2], array.offset, "value");
+
+        const auto& stock_id_array = *array.children[1];
+        std::string_view stock_id_format = schema.children[1]->format;
+        if ((stock_id_format != "u" && stock_id_format != "U") || stock_id_array.n_buffers != 3) {
+            throw std::runtime_error("Arrow column stock_id must be utf8 but has format " +
+                std::string(stock_id_format));
+        }
+        check_no_nulls(stock_id_array, "stock_id");
+
+        const int64_t stock_id_offset = stock_id_array.offset + array.offset;
+        if (stock_id_format == "u") {
+            offsets = static_cast<const int32_t*>(stock_id_array.buffers[1]) + stock_id_offset;
+        } else {
+            large_offsets = static_cast<const int64_t*>(stock_id_array.buffers[1]) + stock_id_offset;
+        }
+        stock_id_data = static_cast<const char*>(stock_id_array.buffers[2]);
+    } catch (...) {
+        array.release(&array);
+        schema.release(&schema);
+        throw;
+    }
+}
+
+arrow_c::ImportedRelation::~ImportedRelation() {
+    if (array.release) {
+        array.release(&array);
+    }
+    if (schema.release) {
+        schema.release(&schema);
+    }
+}
+
+Prices arrow_c::import_prices(ArrowArray* array, ArrowSchema* schema) {
+    ImportedRelation relation(array, schema);
+    const size_t num_rows = relation.num_rows();
+
+    std::vector<uint64_t> timestamps(num_rows);
+    std::vector<std::string> stock_ids(num_rows);
+    std::vector<uint64_t> prices(num_rows);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_rows),
+            [&](tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            timestamps[i] = relation.timestamps()[i];
+            stock_ids[i] = relation.stock_id(i);
+            prices[i] = relation.values()[i];
+        }
+    });
+
+    return /* Prices= */ {
+        /* timestamps= */ timestamps,
+        /* stock_ids= */ stock_ids,
+        /* prices= */ prices,
+        /* size= */ num_rows
+    };
+}
+
+OrderBook arrow_c::import_order_book(ArrowArray* array, ArrowSchema* schema) {
+    auto data = import_prices(array, schema);
+
+    return /* OrderBook= */ {
+        /* timestamps= */ data.timestamps,
+        /* stock_ids= */ data.stock_ids,
+        /* symbol_ids= */ data.symbol_ids,
+        /* amounts= */ data.prices,
+        /* size= */ data.size
+    };
+}
+
+void arrow_c::export_prices(const Prices& prices, ArrowArray* array, ArrowSchema* schema) {
+    auto data = std::make_shared<ExportData>();
+    build_stock_id_column(prices.stock_ids, prices.size, *data);
+    export_columns(data, {
+        {"timestamp", prices.timestamps.data()},
+        {"stock_id", nullptr},
+        {"price", prices.prices.data()}}, prices.size, array, schema);
+}
+
+void arrow_c::export_order_book(const OrderBook& order_book, ArrowArray* array, ArrowSchema* schema) {
+    auto data = std::make_shared<ExportData>();
+    build_stock_id_column(order_book.stock_ids, order_book.size, *data);
+    export_columns(data, {
+        {"timestamp", order_book.timestamps.data()},
+        {"stock_id", nullptr},
+        {"amount", order_book.amounts.data()}}, order_book.size, array, schema);
+}
+
+void arrow_c::export_result(ResultRelation& result, ArrowArray* array, ArrowSchema* schema) {
+    auto data = std::make_shared<ExportData>();
+    data->owned_result = result.gather();
+    const auto& columns = data->owned_result;
+    const size_t num_rows = columns.values.size();
+
+    /// The price side of unmatched orders of a LEFT OUTER join is null, they share one validity bitmap.
+    int64_t null_count = 0;
+    if (result.num_unmatched > 0) {
+        data->price_validity.resize((num_rows + 7) / 8, 0);
+        for (size_t i = 0; i < num_rows; ++i) {
+            if (columns.values[i] == ResultRelation::NULL_VALUE) {
+                ++null_count;
+            } else {
+                data->price_validity[i / 8] |= 1 << (i % 8);
+            }
+        }
+    }
+    const uint8_t* validity = null_count > 0 ? data->price_validity.data() : nullptr;
+
+    build_stock_id_column(columns.order_book_stock_ids, num_rows, *data);
+    export_columns(data, {
+        {"price_timestamp", columns.prices_timestamps.data(), validity, null_count},
+        {"stock_id", nullptr},
+        {"price", columns.prices.data(), validity, null_count},
+        {"order_book_timestamp", columns.order_book_timestamps.data()},
+        {"amount", columns.amounts.data()},
+        {"value", columns.values.data(), validity, null_count}}, num_rows, array, schema);
+}
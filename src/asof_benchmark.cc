@@ -24,6 +24,10 @@ int main(int argc, const char* argv[]) {
 
     //benchmarks::run_uniform_both_sides_benchmark();
 
+    //benchmarks::run_loading_throughput();
+
+    //benchmarks::run_eager_vs_late_materialization();
+
     benchmarks::run_increasing_partitions();
 
     return 0;
@@ -15,11 +15,8 @@ std::pair<Prices, OrderBook> load_data(
     Timer timer;
     timer.start();
 
-    Prices prices = load_prices(prices_path, delimiter, shuffle);
-    std::cout << "### FINISHED LOADING PRICES CSV ###" << std::endl;
-
-    OrderBook order_book = load_order_book(positions_path, delimiter, shuffle);
-    std::cout << "### FINISHED LOADING POSITIONS CSV ###" << std::endl;
+    auto [prices, order_book] = load_prices_and_order_book(prices_path, positions_path, delimiter, shuffle);
+    std::cout << "### FINISHED LOADING PRICES AND POSITIONS CSV ###" << std::endl;
 
     std::cout << "### FINISHED DATA LOADING IN " << timer.stop<milliseconds>() << "[ms] ###" << std::endl;
     std::cout << "Prices num rows: " << prices.timestamps.size() << std::endl;
@@ -57,6 +57,54 @@ void benchmarks::run_benchmark(Prices &prices, OrderBook &order_book, size_t num
         util::run_join_return_best_time(left_partitioning, num_runs);
     std::cout << fmt::format("{}: {}", left_partitioning.get_strategy_name(), left_partitioning_time) << std::endl;
 
+    PartitioningRightBatchedASOFJoin right_batched(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto right_batched_time = util::run_join_return_best_time(right_batched, num_runs);
+    std::cout << fmt::format("{}: {}", right_batched.get_strategy_name(), right_batched_time) << std::endl;
+
+    PartitioningLeftBatchedASOFJoin left_batched(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto left_batched_time = util::run_join_return_best_time(left_batched, num_runs);
+    std::cout << fmt::format("{}: {}", left_batched.get_strategy_name(), left_batched_time) << std::endl;
+
+    PartitioningRightInterleavedASOFJoin right_interleaved(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto right_interleaved_time = util::run_join_return_best_time(right_interleaved, num_runs);
+    std::cout << fmt::format("{}: {}", right_interleaved.get_strategy_name(), right_interleaved_time) << std::endl;
+
+    PartitioningLeftInterleavedASOFJoin left_interleaved(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto left_interleaved_time = util::run_join_return_best_time(left_interleaved, num_runs);
+    std::cout << fmt::format("{}: {}", left_interleaved.get_strategy_name(), left_interleaved_time) << std::endl;
+
+    PartitioningRightEytzingerASOFJoin right_eytzinger(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto right_eytzinger_time = util::run_join_return_best_time(right_eytzinger, num_runs);
+    std::cout << fmt::format("{}: {}", right_eytzinger.get_strategy_name(), right_eytzinger_time) << std::endl;
+
+    PartitioningLeftEytzingerASOFJoin left_eytzinger(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto left_eytzinger_time = util::run_join_return_best_time(left_eytzinger, num_runs);
+    std::cout << fmt::format("{}: {}", left_eytzinger.get_strategy_name(), left_eytzinger_time) << std::endl;
+
+    PartitioningRightKAryASOFJoin right_kary(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto right_kary_time = util::run_join_return_best_time(right_kary, num_runs);
+    std::cout << fmt::format("{}: {}", right_kary.get_strategy_name(), right_kary_time) << std::endl;
+
+    PartitioningRightLearnedASOFJoin right_learned(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto right_learned_time = util::run_join_return_best_time(right_learned, num_runs);
+    std::cout << fmt::format("{}: {}", right_learned.get_strategy_name(), right_learned_time) << std::endl;
+
+    PartitioningLeftLearnedASOFJoin left_learned(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto left_learned_time = util::run_join_return_best_time(left_learned, num_runs);
+    std::cout << fmt::format("{}: {}", left_learned.get_strategy_name(), left_learned_time) << std::endl;
+
+    PartitioningRightBTreeASOFJoin right_btree(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto right_btree_time = util::run_join_return_best_time(right_btree, num_runs);
+    std::cout << fmt::format("{}: {}", right_btree.get_strategy_name(), right_btree_time) << std::endl;
+
+    PartitioningLeftBTreeASOFJoin left_btree(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto left_btree_time = util::run_join_return_best_time(left_btree, num_runs);
+    std::cout << fmt::format("{}: {}", left_btree.get_strategy_name(), left_btree_time) << std::endl;
+
+    AdaptiveASOFJoin adaptive(prices, order_book, LESS_EQUAL_THAN, INNER);
+    auto adaptive_time = util::run_join_return_best_time(adaptive, num_runs);
+    std::cout << fmt::format("{}: {}", adaptive.get_strategy_name(), adaptive_time) << std::endl;
+
     //PartitioningBothSortLeftASOFJoin both_partitioning_sort_left(
     //    prices, order_book, LESS_EQUAL_THAN, INNER);
     //auto both_partitioning_time= util::run_join_return_best_time(both_partitioning_sort_left, num_runs);
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <filesystem>
+#include <vector>
+#include <fmt/format.h>
+#include "relation.hpp"
+#include "columnar_file.hpp"
+#include "benchmark.hpp"
+
+namespace fs = std::filesystem;
+
+
+namespace {
+    double throughput_gb_per_s(size_t num_bytes, uint64_t duration_us) {
+        return static_cast<double>(num_bytes) / 1e9 / (static_cast<double>(duration_us) / 1e6);
+    }
+} // namespace
+
+
+void benchmarks::run_loading_throughput() {
+    size_t num_runs = 3;
+    std::string_view prices_path = "../data/zipf_prices.csv";
+    std::string_view positions_path = "../data/zipf_1_5_positions_2000000.csv";
+
+    std::vector<std::string_view> paths = {prices_path, positions_path};
+    for (auto path : paths) {
+        size_t file_size = fs::file_size(path);
+        std::vector<uint64_t> times(num_runs);
+        size_t num_rows = 0;
+
+        for (size_t i = 0; i < num_runs; ++i) {
+            Timer timer;
+            timer.start();
+            Prices prices = load_prices(path);
+            times[i] = timer.stop();
+            num_rows = prices.size;
+        }
+
+        std::sort(times.begin(), times.end());
+        std::cout << fmt::format("{}: {} rows, {}[us], {:.3f}[GB/s]",
+            path, num_rows, times[0], throughput_gb_per_s(file_size, times[0])) << std::endl;
+    }
+
+    size_t total_size = fs::file_size(prices_path) + fs::file_size(positions_path);
+    std::vector<uint64_t> times(num_runs);
+    for (size_t i = 0; i < num_runs; ++i) {
+        Timer timer;
+        timer.start();
+        auto [prices, order_book] = load_prices_and_order_book(prices_path, positions_path);
+        times[i] = timer.stop();
+    }
+
+    std::sort(times.begin(), times.end());
+    std::cout << fmt::format("Prices + Positions concurrently: {}[us], {:.3f}[GB/s]",
+        times[0], throughput_gb_per_s(total_size, times[0])) << std::endl;
+
+    /// Same inputs converted into the columnar format.
+    for (auto path : paths) {
+        std::string columnar_path = fmt::format("{}{}", path, columnar::FILE_EXTENSION);
+        if (!fs::exists(columnar_path)) {
+            Prices prices = load_prices(path);
+            columnar::write_prices(columnar_path, prices);
+        }
+
+        std::vector<uint64_t> map_times(num_runs);
+        std::vector<uint64_t> load_times(num_runs);
+        for (size_t i = 0; i < num_runs; ++i) {
+            Timer timer;
+            timer.start();
+            columnar::ColumnarFile file(columnar_path);
+            map_times[i] = timer.stop();
+
+            timer.start();
+            Prices prices = load_prices(columnar_path);
+            load_times[i] = timer.stop();
+        }
+
+        std::sort(map_times.begin(), map_times.end());
+        std::sort(load_times.begin(), load_times.end());
+        std::cout << fmt::format("{}: mapped in {}[us], loaded in {}[us]",
+            columnar_path, map_times[0], load_times[0]) << std::endl;
+    }
+}
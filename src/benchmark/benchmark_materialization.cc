@@ -0,0 +1,27 @@
+#include <iostream>
+#include <vector>
+#include <fmt/format.h>
+#include "relation.hpp"
+#include "benchmark.hpp"
+
+
+void benchmarks::run_eager_vs_late_materialization() {
+    size_t num_runs = 3;
+    std::string_view prices_path = "../data/zipf_prices.csv";
+    std::string_view positions_path = "../data/zipf_1_5_positions_2000000.csv";
+
+    auto [prices, order_book] = load_prices_and_order_book(prices_path, positions_path);
+
+    std::vector<std::pair<Materialization, std::string_view>> modes = {
+        {EAGER, "eager"}, {LATE, "late"}, {AGGREGATE, "aggregate"}};
+    for (auto [materialization, name] : modes) {
+        PartitioningLeftASOFJoin left_join(prices, order_book, LESS_EQUAL_THAN, INNER,
+                                           ASOFJoin::NO_MAX_LAG, materialization);
+        PartitioningRightASOFJoin right_join(prices, order_book, LESS_EQUAL_THAN, INNER,
+                                             ASOFJoin::NO_MAX_LAG, materialization);
+
+        uint64_t left_time = util::run_join_return_best_time(left_join, num_runs);
+        uint64_t right_time = util::run_join_return_best_time(right_join, num_runs);
+        std::cout << fmt::format("{}: left {}[us], right {}[us]", name, left_time, right_time) << std::endl;
+    }
+}
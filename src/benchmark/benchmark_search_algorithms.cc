@@ -22,6 +22,7 @@
 namespace {
     struct TestEntry;
     using fn = std::function<TestEntry*(std::vector<TestEntry>&, uint64_t)>;
+    using batch_fn = std::function<void(std::vector<TestEntry>&, const uint64_t*, size_t, TestEntry**)>;
 
     struct TestEntry: ASOFJoin::JoinEntry {
         uint64_t key;
@@ -121,6 +122,39 @@ void benchmark_search(std::vector<TestEntry>& data, std::vector<TestEntry>& targ
 }
 
 
+/// Resolve all targets with one call of an interleaved batch search.
+void benchmark_batch_search(std::vector<TestEntry>& data, std::vector<TestEntry>& targets,
+                            const batch_fn& search, std::string_view label, size_t num_runs) {
+    std::vector<uint64_t> target_keys(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i) {
+        target_keys[i] = targets[i].key;
+    }
+    std::vector<TestEntry*> results(targets.size());
+    std::vector<uint64_t> times(num_runs);
+
+    size_t matches = 0;
+    for (size_t i = 0; i < num_runs; ++i) {
+        Timer timer;
+
+        timer.start();
+        search(data, target_keys.data(), target_keys.size(), results.data());
+        times[i] = timer.stop();
+
+        for (auto* match : results) {
+            matches += match != nullptr;
+        }
+    }
+
+    /// To avoid optimization removing.
+    if (matches == 0) {
+        return;
+    }
+
+    std::sort(times.begin(), times.end());
+    std::cout << fmt::format("{}: {}[us]", label, times[0]) << std::endl;
+}
+
+
 void benchmarks::run_different_search_algorithms() {
     size_t num_runs = 3;
 
@@ -145,6 +179,15 @@ void benchmarks::run_different_search_algorithms() {
          {Search::Interpolation::greater_equal_than<TestEntry>, "Interpolation GE"}
     };
 
+    std::vector<std::pair<batch_fn, std::string_view>> batch_search_algos = {
+         {[](auto& data, auto* targets, size_t count, auto** results) {
+             Search::Interleaved::less_equal_than(data, targets, count, results);
+         }, "Interleaved LE"},
+         {[](auto& data, auto* targets, size_t count, auto** results) {
+             Search::Interleaved::greater_equal_than(data, targets, count, results);
+         }, "Interleaved GE"}
+    };
+
     for (auto& [data, dist_label] : data_dists) {
         std::cout << dist_label << ":" << std::endl;
         for (auto &[search_fn, search_label]: search_algos) {
@@ -155,6 +198,70 @@ void benchmarks::run_different_search_algorithms() {
                 search_label,
                 num_runs);
         }
+
+        /// The layouts are built once per data set, like [[MultiMapTB::build_eytzinger_layouts]] after sorting.
+        Search::Eytzinger::Layout layout(data);
+        benchmark_search(
+            data,
+            uniform_targets,
+            [&layout](auto& data, uint64_t target) {
+                return Search::Eytzinger::less_equal_than(data, layout, target);
+            },
+            "Eytzinger LE",
+            num_runs);
+        benchmark_search(
+            data,
+            uniform_targets,
+            [&layout](auto& data, uint64_t target) {
+                return Search::Eytzinger::greater_equal_than(data, layout, target);
+            },
+            "Eytzinger GE",
+            num_runs);
+
+        Search::KAry::Layout kary_layout(data);
+        benchmark_search(
+            data,
+            uniform_targets,
+            [&kary_layout](auto& data, uint64_t target) {
+                return Search::KAry::less_equal_than(data, kary_layout, target);
+            },
+            "K-ary LE",
+            num_runs);
+        benchmark_search(
+            data,
+            uniform_targets,
+            [&kary_layout](auto& data, uint64_t target) {
+                return Search::KAry::greater_equal_than(data, kary_layout, target);
+            },
+            "K-ary GE",
+            num_runs);
+
+        Search::Learned::Layout learned_layout(data);
+        benchmark_search(
+            data,
+            uniform_targets,
+            [&learned_layout](auto& data, uint64_t target) {
+                return Search::Learned::less_equal_than(data, learned_layout, target);
+            },
+            "Learned LE",
+            num_runs);
+        benchmark_search(
+            data,
+            uniform_targets,
+            [&learned_layout](auto& data, uint64_t target) {
+                return Search::Learned::greater_equal_than(data, learned_layout, target);
+            },
+            "Learned GE",
+            num_runs);
+
+        for (auto &[search_fn, search_label]: batch_search_algos) {
+            benchmark_batch_search(
+                data,
+                uniform_targets,
+                search_fn,
+                search_label,
+                num_runs);
+        }
     }
 }
 
@@ -164,7 +271,7 @@ void benchmarks::run_different_search_algorithms() {
 
 
 void benchmark_left_partition_search(Prices& prices, OrderBook& order_book) {
-    MultiMapTB<ASOFJoin::LeftEntry> order_book_lookup(order_book.stock_ids, order_book.timestamps);
+    MultiMapTB<ASOFJoin::LeftEntry, SymbolId> order_book_lookup(order_book.symbol_ids, order_book.timestamps);
     tbb::parallel_for_each(order_book_lookup.begin(), order_book_lookup.end(),
             [&](auto& iter) {
         tbb::parallel_sort(iter.second.begin(), iter.second.end());
@@ -177,12 +284,12 @@ void benchmark_left_partition_search(Prices& prices, OrderBook& order_book) {
         timer.start();
         //PerfEventBlock e(prices.size);
         for (size_t i = 0; i < 10; ++i) {
-            const auto& stock_id = prices.stock_ids[i];
-            if (!order_book_lookup.contains(stock_id)) {
+            auto symbol_id = prices.symbol_ids[i];
+            if (!order_book_lookup.contains(symbol_id)) {
                 continue;
             }
 
-            auto& partition_bin = order_book_lookup[stock_id];
+            auto& partition_bin = order_book_lookup[symbol_id];
             auto timestamp = prices.timestamps[i];
             auto* match= Search::Interpolation::greater_equal_than(
                 /* data= */ partition_bin,
@@ -206,7 +313,7 @@ void benchmark_left_partition_search(Prices& prices, OrderBook& order_book) {
 
 
 void benchmark_right_partition_search(Prices& prices, OrderBook& order_book) {
-    MultiMapTB<ASOFJoin::RightEntry> prices_lookup(prices.stock_ids, prices.timestamps);
+    MultiMapTB<ASOFJoin::RightEntry, SymbolId> prices_lookup(prices.symbol_ids, prices.timestamps);
     tbb::parallel_for_each(prices_lookup.begin(), prices_lookup.end(),
             [&](auto& iter) {
         tbb::parallel_sort(iter.second.begin(), iter.second.end());
@@ -219,12 +326,12 @@ void benchmark_right_partition_search(Prices& prices, OrderBook& order_book) {
         Timer timer;
         timer.start();
         for (size_t i = 0; i < 10; ++i) {
-            auto &stock_id = order_book.stock_ids[i];
-            if (!prices_lookup.contains(stock_id)) {
+            auto symbol_id = order_book.symbol_ids[i];
+            if (!prices_lookup.contains(symbol_id)) {
                 continue;
             }
 
-            auto &partition_bin = prices_lookup[stock_id];
+            auto &partition_bin = prices_lookup[symbol_id];
             auto timestamp = order_book.timestamps[i];
             auto *match = Search::Interpolation::less_equal_than(
                     /* data= */ partition_bin,
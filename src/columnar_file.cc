@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "columnar_file.hpp"
+
+#include "tbb/parallel_for.h"
+
+
+namespace {
+    size_t align_up(size_t offset) {
+        return (offset + columnar::SECTION_ALIGNMENT - 1) & ~(columnar::SECTION_ALIGNMENT - 1);
+    }
+
+    void write_padding(std::ofstream& out, size_t offset) {
+        static constexpr char zeros[columnar::SECTION_ALIGNMENT] = {};
+        out.write(zeros, static_cast<std::streamsize>(align_up(offset) - offset));
+    }
+
+    template<typename T>
+    void write_column(std::ofstream& out, const std::vector<T>& column) {
+        out.write(reinterpret_cast<const char*>(column.data()),
+                  static_cast<std::streamsize>(column.size() * sizeof(T)));
+    }
+} // namespace
+
+columnar::ColumnarFile::ColumnarFile(std::string_view path): file(path) {
+    const size_t file_size = file.file_size();
+    if (file_size < sizeof(ColumnarHeader)) {
+        throw std::runtime_error("Columnar file is too small " + std::string(path));
+    }
+
+    header = reinterpret_cast<const ColumnarHeader*>(file.begin());
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header->version != VERSION ||
+            header->symbol_id_size != sizeof(SymbolId)) {
+        throw std::runtime_error("Invalid columnar file header " + std::string(path));
+    }
+
+    const size_t num_rows = header->num_rows;
+    if (header->timestamps_offset % SECTION_ALIGNMENT != 0 ||
+            header->values_offset % SECTION_ALIGNMENT != 0 ||
+            header->symbol_ids_offset % SECTION_ALIGNMENT != 0 ||
+            header->dictionary_offset % SECTION_ALIGNMENT != 0) {
+        throw std::runtime_error("Unaligned columnar file sections " + std::string(path));
+    }
+    if (!file.fits(header->timestamps_offset, num_rows, sizeof(uint64_t)) ||
+            !file.fits(header->values_offset, num_rows, sizeof(uint64_t)) ||
+            !file.fits(header->symbol_ids_offset, num_rows, sizeof(SymbolId))) {
+        throw std::runtime_error("Truncated columnar file " + std::string(path));
+    }
+
+    dictionary = MappedDictionary(file, header->dictionary_offset, header->num_symbols,
+                                  "columnar file " + std::string(path));
+}
+
+std::span<const uint64_t> columnar::ColumnarFile::timestamps() const {
+    return {reinterpret_cast<const uint64_t*>(file.begin() + header->timestamps_offset), num_rows()};
+}
+
+std::span<const uint64_t> columnar::ColumnarFile::values() const {
+    return {reinterpret_cast<const uint64_t*>(file.begin() + header->values_offset), num_rows()};
+}
+
+std::span<const SymbolId> columnar::ColumnarFile::symbol_ids() const {
+    return {reinterpret_cast<const SymbolId*>(file.begin() + header->symbol_ids_offset), num_rows()};
+}
+
+void columnar::write(std::string_view path,
+                     const std::vector<uint64_t>& timestamps,
+                     const std::vector<SymbolId>& symbol_ids,
+                     const std::vector<uint64_t>& values) {
+    const size_t num_rows = timestamps.size();
+    assert(symbol_ids.size() == num_rows && values.size() == num_rows);
+
+    /// Store the shared dictionary up to the largest used id, such that loading the file
+    /// in a new process assigns the same ids.
+    size_t num_symbols = 0;
+    for (auto id : symbol_ids) {
+        num_symbols = std::max<size_t>(num_symbols, id + 1);
+    }
+
+    std::vector<uint64_t> symbol_offsets(num_symbols + 1, 0);
+    std::string symbol_bytes;
+    for (SymbolId id = 0; id < num_symbols; ++id) {
+        symbol_bytes += SymbolDictionary::shared().decode(id);
+        symbol_offsets[id + 1] = symbol_bytes.size();
+    }
+
+    ColumnarHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.symbol_id_size = sizeof(SymbolId);
+    header.num_rows = num_rows;
+    header.num_symbols = num_symbols;
+    header.timestamps_offset = align_up(sizeof(ColumnarHeader));
+    header.values_offset = align_up(header.timestamps_offset + num_rows * sizeof(uint64_t));
+    header.symbol_ids_offset = align_up(header.values_offset + num_rows * sizeof(uint64_t));
+    header.dictionary_offset = align_up(header.symbol_ids_offset + num_rows * sizeof(SymbolId));
+
+    std::ofstream out(std::string(path), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to open " + std::string(path));
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(ColumnarHeader));
+    write_padding(out, sizeof(ColumnarHeader));
+    write_column(out, timestamps);
+    write_padding(out, header.timestamps_offset + num_rows * sizeof(uint64_t));
+    write_column(out, values);
+    write_padding(out, header.values_offset + num_rows * sizeof(uint64_t));
+    write_column(out, symbol_ids);
+    write_padding(out, header.symbol_ids_offset + num_rows * sizeof(SymbolId));
+    write_column(out, symbol_offsets);
+    out.write(symbol_bytes.data(), static_cast<std::streamsize>(symbol_bytes.size()));
+
+    if (!out) {
+        throw std::runtime_error("Failed to write " + std::string(path));
+    }
+}
+
+void columnar::write_prices(std::string_view path, const Prices& prices) {
+    write(path, prices.timestamps, prices.symbol_ids, prices.prices);
+}
+
+void columnar::write_order_book(std::string_view path, const OrderBook& order_book) {
+    write(path, order_book.timestamps, order_book.symbol_ids, order_book.amounts);
+}
+
+Prices columnar::load_prices(std::string_view path) {
+    ColumnarFile file(path);
+    const size_t num_rows = file.num_rows();
+
+    /// Encode only the dictionary of the file, the rows are remapped from the ids of the file to the shared ids.
+    std::vector<SymbolId> shared_ids(file.num_symbols());
+    std::vector<std::string> symbols(file.num_symbols());
+    for (SymbolId id = 0; id < file.num_symbols(); ++id) {
+        symbols[id] = file.symbol(id);
+        shared_ids[id] = SymbolDictionary::shared().encode(symbols[id]);
+    }
+
+    auto file_timestamps = file.timestamps();
+    auto file_values = file.values();
+    auto file_symbol_ids = file.symbol_ids();
+
+    std::vector<uint64_t> timestamps(num_rows);
+    std::vector<std::string> stock_ids(num_rows);
+    std::vector<SymbolId> symbol_ids(num_rows);
+    std::vector<uint64_t> prices(num_rows);
+
+    /// Copy out of the mapping in parallel, such that the page faults are spread over all threads.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_rows),
+            [&](tbb::blocked_range<size_t>& range) {
+        const size_t begin = range.begin();
+        const size_t count = range.end() - range.begin();
+        std::memcpy(timestamps.data() + begin, file_timestamps.data() + begin, count * sizeof(uint64_t));
+        std::memcpy(prices.data() + begin, file_values.data() + begin, count * sizeof(uint64_t));
+
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            auto file_id = file_symbol_ids[i];
+            if (file_id >= shared_ids.size()) {
+                throw std::runtime_error("Invalid symbol id in columnar file " + std::string(path));
+            }
+            symbol_ids[i] = shared_ids[file_id];
+            /// The joins reference the stock ids of the relation in their results.
+            stock_ids[i] = symbols[file_id];
+        }
+    });
+
+    return /* Prices= */ {
+        /* timestamps= */ timestamps,
+        /* stock_ids= */ stock_ids,
+        /* symbol_ids= */ symbol_ids,
+        /* prices= */ prices,
+        /* size= */ num_rows
+    };
+}
+
+OrderBook columnar::load_order_book(std::string_view path) {
+    auto data = load_prices(path);
+
+    return /* OrderBook= */ {
+        /* timestamps= */ data.timestamps,
+        /* stock_ids= */ data.stock_ids,
+        /* symbol_ids= */ data.symbol_ids,
+        /* amounts= */ data.prices,
+        /* size= */ data.size
+    };
+}
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include "csv_parser.hpp"
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+
+namespace {
+    constexpr uint64_t TEN_POW_8 = 100'000'000;
+    constexpr uint64_t TEN_POW_16 = 10'000'000'000'000'000;
+
+    /// Loading 16 bytes at [[PREFIX_MASK + n]] sets the first [[16 - n]] bytes.
+    alignas(32) constexpr uint8_t PREFIX_MASK[32] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+
+    template<typename ParseNumber>
+    [[gnu::always_inline]] inline void add_row(const std::string_view (&fields)[3], bool is_first_range,
+                                               csv::Columns& columns, ParseNumber parse_number) {
+        // Check if a header exists for the first row.
+        // Currently, it only checks if the first field starts with "time".
+        // If so, we assume that it is a header for our specific csv format.
+        if (is_first_range && columns.timestamps.empty() && fields[0].starts_with("time")) {
+            return;
+        }
+
+        columns.timestamps.push_back(parse_number(fields[0]));
+        columns.stock_ids.emplace_back(fields[1]);
+        columns.values.push_back(parse_number(fields[2]));
+    }
+} // namespace
+
+uint64_t csv::string_view_to_uint64_t(std::string_view strv) {
+    uint64_t result{};
+
+    auto [_, ec] = std::from_chars(strv.data(), strv.data() + strv.size(), result);
+
+    if (ec != std::errc()) {
+        throw std::runtime_error("Failed to parse uint64_t from string_view " + std::string(strv));
+    }
+
+    return result;
+}
+
+bool csv::avx2_supported() {
+#ifdef __x86_64__
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void csv::parse_rows(const char* buffer_begin, const char* begin, const char* end,
+                     char delimiter, bool is_first_range, Columns& columns) {
+    if (avx2_supported()) {
+        parse_rows_avx2(buffer_begin, begin, end, delimiter, is_first_range, columns);
+    } else {
+        parse_rows_scalar(begin, end, delimiter, is_first_range, columns);
+    }
+}
+
+void csv::parse_rows_scalar(const char* begin, const char* end,
+                            char delimiter, bool is_first_range, Columns& columns) {
+    std::string_view fields[3];
+
+    for (auto iter = begin; iter < end;) {
+        size_t field_idx = 0;
+        for (auto last = iter;; ++iter) {
+            if (iter == end || *iter == '\n') {
+                std::string_view entry(last, iter - last);
+                fields[field_idx] = entry;
+                ++iter;
+                break;
+            } else if (*iter == delimiter) {
+                std::string_view entry(last, iter - last);
+                fields[field_idx++] = entry;
+                last = iter + 1;
+            }
+        }
+
+        add_row(fields, is_first_range, columns, string_view_to_uint64_t);
+    }
+}
+
+#ifdef __x86_64__
+
+[[gnu::target("avx2")]]
+uint64_t csv::parse_uint64_simd(const char* buffer_begin, std::string_view field) {
+    const size_t len = field.size();
+    const char* field_end = field.data() + len;
+    if (len == 0 || len > 19 || field_end - 16 < buffer_begin) {
+        return string_view_to_uint64_t(field);
+    }
+
+    /// Load the last (up to) 16 digits right aligned and overwrite the bytes in front of them with '0'.
+    const size_t num_simd_digits = std::min<size_t>(len, 16);
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(field_end - 16));
+    __m128i prefix = _mm_loadu_si128(reinterpret_cast<const __m128i*>(PREFIX_MASK + num_simd_digits));
+    chars = _mm_blendv_epi8(chars, _mm_set1_epi8('0'), prefix);
+
+    /// Characters below '0' wrap around, so every non-digit is greater than 9.
+    __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i nine = _mm_set1_epi8(9);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, nine), nine)) != 0xFFFF) {
+        return string_view_to_uint64_t(field);
+    }
+
+    /// Combine neighbouring digits to 2-, 4- and 8-digit numbers, as done in simdjson.
+    __m128i pairs = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+    __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    quads = _mm_packus_epi32(quads, quads);
+    __m128i octs = _mm_madd_epi16(quads, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+    uint64_t high = static_cast<uint32_t>(_mm_cvtsi128_si32(octs));
+    uint64_t low = static_cast<uint32_t>(_mm_extract_epi32(octs, 1));
+    uint64_t value = high * TEN_POW_8 + low;
+
+    /// At most three leading digits in front of the last 16 digits, which cannot overflow.
+    uint64_t leading = 0;
+    for (const char* iter = field.data(); iter < field_end - num_simd_digits; ++iter) {
+        if (*iter < '0' || *iter > '9') {
+            return string_view_to_uint64_t(field);
+        }
+        leading = leading * 10 + (*iter - '0');
+    }
+
+    return leading * TEN_POW_16 + value;
+}
+
+[[gnu::target("avx2")]]
+void csv::parse_rows_avx2(const char* buffer_begin, const char* begin, const char* end,
+                          char delimiter, bool is_first_range, Columns& columns) {
+    auto parse_number = [buffer_begin](std::string_view field) {
+        return parse_uint64_simd(buffer_begin, field);
+    };
+
+    std::string_view fields[3];
+    size_t field_idx = 0;
+    const char* field_start = begin;
+
+    const __m256i delimiters = _mm256_set1_epi8(delimiter);
+    const __m256i newlines = _mm256_set1_epi8('\n');
+
+    for (const char* block = begin; block < end; block += 32) {
+        /// Bitmask of all structural characters, i.e. delimiters and newlines, in the block.
+        uint32_t mask = 0;
+        if (block + 32 <= end) {
+            __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+            mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(
+                _mm256_cmpeq_epi8(chars, delimiters),
+                _mm256_cmpeq_epi8(chars, newlines))));
+        } else {
+            for (size_t i = 0; block + i < end; ++i) {
+                mask |= static_cast<uint32_t>(block[i] == delimiter || block[i] == '\n') << i;
+            }
+        }
+
+        while (mask != 0) {
+            const char* pos = block + __builtin_ctz(mask);
+            mask &= mask - 1;
+
+            fields[field_idx] = std::string_view(field_start, pos - field_start);
+            field_start = pos + 1;
+
+            if (*pos == '\n') {
+                add_row(fields, is_first_range, columns, parse_number);
+                field_idx = 0;
+            } else if (field_idx < 2) {
+                ++field_idx;
+            }
+        }
+    }
+
+    /// Last row without a trailing newline.
+    if (field_start < end) {
+        fields[field_idx] = std::string_view(field_start, end - field_start);
+        add_row(fields, is_first_range, columns, parse_number);
+    }
+}
+
+#else
+
+uint64_t csv::parse_uint64_simd(const char* buffer_begin, std::string_view field) {
+    return string_view_to_uint64_t(field);
+}
+
+void csv::parse_rows_avx2(const char* buffer_begin, const char* begin, const char* end,
+                          char delimiter, bool is_first_range, Columns& columns) {
+    parse_rows_scalar(begin, end, delimiter, is_first_range, columns);
+}
+
+#endif
@@ -0,0 +1,37 @@
+#include <iostream>
+#include <string>
+#include "columnar_file.hpp"
+#include "relation.hpp"
+#include "timer.hpp"
+
+
+/// Convert csv files of our format "timestamp,stock_id,value" into columnar files.
+/// All inputs are converted in the same process and share one symbol dictionary, so that
+/// files which are joined together are loaded with consistent symbol ids.
+int main(int argc, char** argv) {
+    if (argc < 3 || argc % 2 == 0) {
+        std::cerr << "Usage: " << argv[0] << " <input.csv> <output" << columnar::FILE_EXTENSION
+                  << "> [<input.csv> <output" << columnar::FILE_EXTENSION << "> ...]" << std::endl;
+        return 1;
+    }
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string input_path = argv[i];
+        std::string output_path = argv[i + 1];
+
+        Timer timer;
+        timer.start();
+        Prices relation = load_prices(input_path);
+        auto load_duration = timer.stop<milliseconds>();
+
+        timer.start();
+        columnar::write_prices(output_path, relation);
+        auto write_duration = timer.stop<milliseconds>();
+
+        std::cout << "Converted " << input_path << " -> " << output_path << " ("
+                  << relation.size << " rows, loaded in " << load_duration << "[ms], written in "
+                  << write_duration << "[ms])" << std::endl;
+    }
+
+    return 0;
+}
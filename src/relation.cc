@@ -1,10 +1,15 @@
 #include <string>
 #include <random>
+#include <optional>
 #include "relation.hpp"
 #include "mmap_file.hpp"
+#include "columnar_file.hpp"
+#include "csv_parser.hpp"
 #include "uniform_gen.hpp"
 #include "zipf_gen.hpp"
 
+#include "tbb/parallel_invoke.h"
+
 
 Prices shuffle_prices(Prices& prices) {
     std::vector<size_t> indices(prices.size);
@@ -15,70 +20,99 @@ Prices shuffle_prices(Prices& prices) {
 
     std::vector<uint64_t> timestamps_tmp(prices.size);
     std::vector<std::string> stock_ids_tmp(prices.size);
+    std::vector<SymbolId> symbol_ids_tmp(prices.size);
     std::vector<uint64_t> prices_tmp(prices.size);
 
     for (size_t i = 0; i < prices.size; ++i) {
         timestamps_tmp[i] = prices.timestamps[indices[i]];
         stock_ids_tmp[i] = prices.stock_ids[indices[i]];
+        symbol_ids_tmp[i] = prices.symbol_ids[indices[i]];
         prices_tmp[i] = prices.prices[indices[i]];
     }
 
-    return {timestamps_tmp, stock_ids_tmp, prices_tmp, prices.size};
+    return {timestamps_tmp, stock_ids_tmp, symbol_ids_tmp, prices_tmp, prices.size};
 }
 
-uint64_t string_view_to_uint64_t(std::string_view strv) {
-    uint64_t result{};
+namespace {
+    /// Size of a chunk of the csv file which is parsed by a single task.
+    constexpr size_t CSV_CHUNK_SIZE = 1 << 22;
 
-    auto [_, ec] = std::from_chars(strv.data(), strv.data() + strv.size(), result);
+    /// Return the first row start at or after [[pos]].
+    const char* next_row_start(const char* begin, const char* end, const char* pos) {
+        if (pos <= begin) {
+            return begin;
+        }
+        if (pos >= end) {
+            return end;
+        }
 
-    if (ec != std::errc()) {
-        throw std::runtime_error("Failed to parse uint64_t from string_view " + std::string(strv));
+        /// [[pos]] starts a row iff the previous character is a newline.
+        const auto* newline = static_cast<const char*>(memchr(pos - 1, '\n', end - pos + 1));
+        return newline ? newline + 1 : end;
     }
 
-    return result;
-}
+    /// Copy [[src]] into [[dest]] starting at [[offset]].
+    template<typename T>
+    void stitch_column(std::vector<T>& src, std::vector<T>& dest, size_t offset) {
+        std::move(src.begin(), src.end(), dest.begin() + offset);
+        std::vector<T>().swap(src);
+    }
+} // namespace
 
 Prices load_prices(std::string_view path, char delimiter, bool shuffle) {
+    if (path.ends_with(columnar::FILE_EXTENSION)) {
+        Prices result = columnar::load_prices(path);
+        return shuffle ? shuffle_prices(result) : result;
+    }
+
     MemoryMappedFile file(path);
+    const char* begin = file.begin();
+    const char* end = file.end();
 
-    std::vector<uint64_t> timestamps;
-    std::vector<std::string> stock_ids;
-    std::vector<uint64_t> prices;
-    std::string_view columns[3];
-
-    for (auto iter = file.begin(), limit = file.end(); iter < limit;) {
-        size_t column_idx = 0;
-        for (auto last = iter;; ++iter) {
-            if (*iter == delimiter) {
-                std::string_view entry(last, iter - last);
-                columns[column_idx++] = entry;
-                last = iter + 1;
-            } else if (*iter == '\n') {
-                std::string_view entry(last, iter - last);
-                columns[column_idx] = entry;
-                ++iter;
-                break;
-            }
-        }
+    /// Split the file into newline aligned chunks. Each chunk owns all rows starting
+    /// in its range and is parsed into its own columns.
+    const size_t num_chunks = std::max<size_t>(1, (end - begin + CSV_CHUNK_SIZE - 1) / CSV_CHUNK_SIZE);
+    std::vector<csv::Columns> chunks(num_chunks);
 
-        // Check if a header exists for the first row.
-        // Currently, it only checks if the first field starts with "time".
-        // If so, we assume that it is a header for our specific csv format.
-        if (timestamps.empty() && columns[0].starts_with("time")) {
-            continue;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+            [&](tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            const char* chunk_begin = next_row_start(begin, end, begin + i * CSV_CHUNK_SIZE);
+            const char* chunk_end = next_row_start(begin, end, begin + (i + 1) * CSV_CHUNK_SIZE);
+            csv::parse_rows(begin, chunk_begin, chunk_end, delimiter, /* is_first_range= */ i == 0, chunks[i]);
         }
+    });
 
-        timestamps.push_back(string_view_to_uint64_t(columns[0]));
-        stock_ids.emplace_back(columns[1]);
-        prices.push_back(string_view_to_uint64_t(columns[2]));
+    /// Stitch the chunks together by moving them in parallel to their prefix sum offsets.
+    std::vector<size_t> offsets(num_chunks + 1, 0);
+    for (size_t i = 0; i < num_chunks; ++i) {
+        offsets[i + 1] = offsets[i] + chunks[i].timestamps.size();
     }
 
+    const size_t num_rows = offsets[num_chunks];
+    std::vector<uint64_t> timestamps(num_rows);
+    std::vector<std::string> stock_ids(num_rows);
+    std::vector<uint64_t> prices(num_rows);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+            [&](tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            stitch_column(chunks[i].timestamps, timestamps, offsets[i]);
+            stitch_column(chunks[i].stock_ids, stock_ids, offsets[i]);
+            stitch_column(chunks[i].values, prices, offsets[i]);
+        }
+    });
+
     assert(timestamps.size() == stock_ids.size() &&
         stock_ids.size() == prices.size());
 
+    /// Encode the stock ids with the dictionary shared by all relations.
+    auto symbol_ids = SymbolDictionary::shared().encode(stock_ids);
+
     Prices result = {
         /* timestamps= */ timestamps,
         /* stock_ids= */ stock_ids,
+        /* symbol_ids= */ symbol_ids,
         /* prices= */ prices,
         /* size= */ timestamps.size()
     };
@@ -92,11 +126,25 @@ OrderBook load_order_book(std::string_view path, char delimiter, bool shuffle) {
     return /* OrderBook= */ {
         /* timestamps= */ data.timestamps,
         /* stock_ids= */ data.stock_ids,
+        /* symbol_ids= */ data.symbol_ids,
         /* amounts= */ data.prices,
         /* size= */ data.size
     };
 }
 
+std::pair<Prices, OrderBook> load_prices_and_order_book(
+        std::string_view prices_path, std::string_view order_book_path, char delimiter, bool shuffle) {
+    std::optional<Prices> prices;
+    std::optional<OrderBook> order_book;
+
+    tbb::parallel_invoke(
+        [&] { prices.emplace(load_prices(prices_path, delimiter, shuffle)); },
+        [&] { order_book.emplace(load_order_book(order_book_path, delimiter, shuffle)); }
+    );
+
+    return {std::move(*prices), std::move(*order_book)};
+}
+
 Prices generate_equal_distributed_prices(size_t num_prices, size_t price_sampling_rate, size_t num_diff_stocks) {
     std::vector<uint64_t> timestamps;
     std::vector<uint64_t> prices;
@@ -261,9 +309,13 @@ Prices select_first_n_prices(Prices& prices_og, size_t n) {
     std::vector<std::string> stock_ids(n);
     std::copy_n(prices_og.stock_ids.begin(), n, stock_ids.begin());
 
+    std::vector<SymbolId> symbol_ids(n);
+    std::copy_n(prices_og.symbol_ids.begin(), n, symbol_ids.begin());
+
     return /* Prices= */ {
         /* timestamps= */ timestamps,
         /* stock_ids= */ stock_ids,
+        /* symbol_ids= */ symbol_ids,
         /* prices= */ prices,
         /* size= */ n
     };
@@ -279,10 +331,300 @@ OrderBook select_first_n_orders(OrderBook& order_book, size_t n) {
     std::vector<std::string> stock_ids(n);
     std::copy_n(order_book.stock_ids.begin(), n, stock_ids.begin());
 
+    std::vector<SymbolId> symbol_ids(n);
+    std::copy_n(order_book.symbol_ids.begin(), n, symbol_ids.begin());
+
     return /* OrderBook= */ {
         /* timestamps= */ timestamps,
         /* stock_ids= */ stock_ids,
+        /* symbol_ids= */ symbol_ids,
         /* amounts= */ amounts,
         /* size= */ n
     };
 }
+
+namespace {
+    /// Number of rows ahead of the current one whose payload is prefetched when materializing matches.
+    constexpr size_t PREFETCH_DISTANCE = 16;
+    /// Matches are materialized in batches, such that the arithmetic of a batch is vectorized.
+    constexpr size_t MATERIALIZE_BATCH_SIZE = 256;
+
+    /// Chunk of a thread with its number of rows and its position in the gathered columns.
+    struct GatherTask {
+        const ResultChunk* chunk;
+        size_t num_rows;
+        size_t offset;
+    };
+
+    /// Chunk of late materialized matches and its position in the gathered columns.
+    struct MatchTask {
+        const MatchChunk* chunk;
+        size_t num_rows;
+        size_t offset;
+    };
+
+    std::vector<GatherTask> gather_tasks(tbb::enumerable_thread_specific<ResultRelation::OutputData>& thread_data) {
+        std::vector<GatherTask> tasks;
+        size_t offset = 0;
+        for (auto& data : thread_data) {
+            for (size_t i = 0; i < data.chunks.size(); ++i) {
+                size_t num_rows = std::min(ResultChunk::CAPACITY, data.size - i * ResultChunk::CAPACITY);
+                tasks.push_back({data.chunks[i], num_rows, offset});
+                offset += num_rows;
+            }
+        }
+        return tasks;
+    }
+
+    /// Late materialized matches are placed after all eagerly inserted rows starting at [[offset]].
+    std::vector<MatchTask> match_tasks(tbb::enumerable_thread_specific<ResultRelation::OutputData>& thread_data,
+                                       size_t offset) {
+        std::vector<MatchTask> tasks;
+        for (auto& data : thread_data) {
+            for (size_t i = 0; i < data.match_chunks.size(); ++i) {
+                size_t num_rows = std::min(MatchChunk::CAPACITY, data.num_matches - i * MatchChunk::CAPACITY);
+                tasks.push_back({data.match_chunks[i], num_rows, offset});
+                offset += num_rows;
+            }
+        }
+        return tasks;
+    }
+
+    template<typename Task>
+    size_t total_rows(const std::vector<Task>& tasks, size_t empty_rows) {
+        return tasks.empty() ? empty_rows : tasks.back().offset + tasks.back().num_rows;
+    }
+
+    template<typename Task, typename Func>
+    void for_each_task(const std::vector<Task>& tasks, Func&& func) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, tasks.size(), 1),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                func(tasks[i]);
+            }
+        });
+    }
+
+    /// Call [[func]] for each batch of [[task]] after prefetching the payload of the matches,
+    /// which are random accesses into the input relations.
+    template<typename Func>
+    void for_each_match_batch(const MatchTask& task, const Prices& prices, const OrderBook& order_book,
+                              Func&& func) {
+        const auto* chunk = task.chunk;
+        for (size_t begin = 0; begin < task.num_rows; begin += MATERIALIZE_BATCH_SIZE) {
+            const size_t end = std::min(task.num_rows, begin + MATERIALIZE_BATCH_SIZE);
+            for (size_t i = begin; i < std::min(task.num_rows, end + PREFETCH_DISTANCE); ++i) {
+                __builtin_prefetch(&order_book.amounts[chunk->order_idxs[i]]);
+                if (chunk->price_idxs[i] != ResultRelation::NO_MATCH) {
+                    __builtin_prefetch(&prices.prices[chunk->price_idxs[i]]);
+                }
+            }
+            func(begin, end);
+        }
+    }
+
+    /// Compute the values of the matches in [begin, end) of [[chunk]] into [[values]].
+    /// Prices and amounts are fetched in a separate loop, such that the multiplication is vectorized.
+    void materialize_values(const MatchChunk* chunk, size_t begin, size_t end,
+                            const Prices& prices, const OrderBook& order_book, uint64_t* values) {
+        alignas(64) uint64_t batch_prices[MATERIALIZE_BATCH_SIZE];
+        alignas(64) uint64_t batch_amounts[MATERIALIZE_BATCH_SIZE];
+        const size_t num_rows = end - begin;
+
+        for (size_t i = 0; i < num_rows; ++i) {
+            size_t price_idx = chunk->price_idxs[begin + i];
+            batch_prices[i] = price_idx == ResultRelation::NO_MATCH ? 0 : prices.prices[price_idx];
+            batch_amounts[i] = order_book.amounts[chunk->order_idxs[begin + i]];
+        }
+        for (size_t i = 0; i < num_rows; ++i) {
+            values[i] = batch_prices[i] * batch_amounts[i];
+        }
+        for (size_t i = 0; i < num_rows; ++i) {
+            if (chunk->price_idxs[begin + i] == ResultRelation::NO_MATCH) {
+                values[i] = ResultRelation::NULL_VALUE;
+            }
+        }
+    }
+
+    /// Output columns of materialized rows, see [[materialize_rows]].
+    struct RowColumns {
+        uint64_t* prices_timestamps;
+        uint64_t* prices;
+        uint64_t* order_book_timestamps;
+        std::string_view* order_book_stock_ids;
+        SymbolId* order_book_symbol_ids;
+        uint64_t* amounts;
+        uint64_t* values;
+    };
+
+    /// Fetch the payload of all matches of [[task]] into the rows of [[out]].
+    void materialize_rows(const MatchTask& task, const Prices& prices, const OrderBook& order_book,
+                          const RowColumns& out) {
+        const auto* chunk = task.chunk;
+        for_each_match_batch(task, prices, order_book, [&](size_t begin, size_t end) {
+            materialize_values(chunk, begin, end, prices, order_book, out.values + begin);
+            for (size_t i = begin; i < end; ++i) {
+                const size_t order_idx = chunk->order_idxs[i];
+                const size_t price_idx = chunk->price_idxs[i];
+                const bool matched = price_idx != ResultRelation::NO_MATCH;
+                out.prices_timestamps[i] = matched ? prices.timestamps[price_idx] : ResultRelation::NULL_VALUE;
+                out.prices[i] = matched ? prices.prices[price_idx] : ResultRelation::NULL_VALUE;
+                out.order_book_timestamps[i] = order_book.timestamps[order_idx];
+                out.order_book_stock_ids[i] = order_book.stock_ids[order_idx];
+                out.order_book_symbol_ids[i] = order_book.symbol_ids[order_idx];
+                out.amounts[i] = order_book.amounts[order_idx];
+            }
+        });
+    }
+} // namespace
+
+void ResultRelation::finalize(const Prices& prices, const OrderBook& order_book) {
+    matched_prices = &prices;
+    matched_order_book = &order_book;
+    finalize();
+
+    auto tasks = match_tasks(thread_data, /* offset= */ 0);
+    tbb::enumerable_thread_specific<std::pair<size_t, size_t>> sums;
+    for_each_task(tasks, [&](const MatchTask& task) {
+        auto& [task_value_sum, task_num_unmatched] = sums.local();
+        alignas(64) uint64_t values[MATERIALIZE_BATCH_SIZE];
+        for_each_match_batch(task, prices, order_book, [&](size_t begin, size_t end) {
+            materialize_values(task.chunk, begin, end, prices, order_book, values);
+            for (size_t i = 0; i < end - begin; ++i) {
+                if (values[i] == NULL_VALUE) {
+                    ++task_num_unmatched;
+                } else {
+                    task_value_sum += values[i];
+                }
+            }
+        });
+    });
+
+    for (auto& [task_value_sum, task_num_unmatched] : sums) {
+        value_sum += task_value_sum;
+        num_unmatched += task_num_unmatched;
+    }
+    size += total_rows(tasks, 0);
+}
+
+ResultColumns ResultRelation::gather() {
+    auto tasks = gather_tasks(thread_data);
+    size_t num_eager_rows = total_rows(tasks, 0);
+    auto late_tasks = matched_prices ? match_tasks(thread_data, num_eager_rows) : std::vector<MatchTask>();
+    size_t num_rows = total_rows(late_tasks, num_eager_rows);
+
+    ResultColumns columns;
+    columns.prices_timestamps.resize(num_rows);
+    columns.prices.resize(num_rows);
+    columns.order_book_timestamps.resize(num_rows);
+    columns.order_book_stock_ids.resize(num_rows);
+    columns.order_book_symbol_ids.resize(num_rows);
+    columns.amounts.resize(num_rows);
+    columns.values.resize(num_rows);
+
+    for_each_task(tasks, [&](const GatherTask& task) {
+        const auto* chunk = task.chunk;
+        std::copy_n(chunk->prices_timestamps, task.num_rows, columns.prices_timestamps.begin() + task.offset);
+        std::copy_n(chunk->prices, task.num_rows, columns.prices.begin() + task.offset);
+        std::copy_n(chunk->order_book_timestamps, task.num_rows, columns.order_book_timestamps.begin() + task.offset);
+        std::copy_n(chunk->order_book_stock_ids, task.num_rows, columns.order_book_stock_ids.begin() + task.offset);
+        std::copy_n(chunk->order_book_symbol_ids, task.num_rows,
+                    columns.order_book_symbol_ids.begin() + task.offset);
+        std::copy_n(chunk->amounts, task.num_rows, columns.amounts.begin() + task.offset);
+        std::copy_n(chunk->values, task.num_rows, columns.values.begin() + task.offset);
+    });
+
+    for_each_task(late_tasks, [&](const MatchTask& task) {
+        materialize_rows(task, *matched_prices, *matched_order_book, {
+            columns.prices_timestamps.data() + task.offset,
+            columns.prices.data() + task.offset,
+            columns.order_book_timestamps.data() + task.offset,
+            columns.order_book_stock_ids.data() + task.offset,
+            columns.order_book_symbol_ids.data() + task.offset,
+            columns.amounts.data() + task.offset,
+            columns.values.data() + task.offset});
+    });
+
+    return columns;
+}
+
+std::vector<ResultChunkView> ResultRelation::chunk_views() {
+    auto tasks = gather_tasks(thread_data);
+    size_t num_eager_rows = total_rows(tasks, 0);
+    auto late_tasks = matched_prices ? match_tasks(thread_data, num_eager_rows) : std::vector<MatchTask>();
+
+    std::vector<ResultChunkView> views;
+    views.reserve(tasks.size() + late_tasks.size());
+    for (const auto& task : tasks) {
+        views.push_back({task.chunk, nullptr, task.num_rows, task.offset});
+    }
+    for (const auto& task : late_tasks) {
+        views.push_back({nullptr, task.chunk, task.num_rows, task.offset});
+    }
+    return views;
+}
+
+const ResultChunk& ResultRelation::chunk_rows(const ResultChunkView& view, ResultChunk& buffer) const {
+    if (view.rows != nullptr) {
+        return *view.rows;
+    }
+
+    static_assert(MatchChunk::CAPACITY <= ResultChunk::CAPACITY);
+    materialize_rows({view.matches, view.num_rows, view.offset}, *matched_prices, *matched_order_book, {
+        buffer.prices_timestamps, buffer.prices, buffer.order_book_timestamps,
+        buffer.order_book_stock_ids, buffer.order_book_symbol_ids, buffer.amounts, buffer.values});
+    return buffer;
+}
+
+std::vector<uint64_t> ResultRelation::collect_values() {
+    auto tasks = gather_tasks(thread_data);
+    size_t num_eager_rows = total_rows(tasks, 0);
+    auto late_tasks = matched_prices ? match_tasks(thread_data, num_eager_rows) : std::vector<MatchTask>();
+    size_t num_rows = total_rows(late_tasks, num_eager_rows);
+
+    std::vector<uint64_t> values(num_rows);
+    for_each_task(tasks, [&](const GatherTask& task) {
+        std::copy_n(task.chunk->values, task.num_rows, values.begin() + task.offset);
+    });
+
+    /// Only prices and amounts are fetched for the late materialized matches.
+    for_each_task(late_tasks, [&](const MatchTask& task) {
+        for_each_match_batch(task, *matched_prices, *matched_order_book, [&](size_t begin, size_t end) {
+            materialize_values(task.chunk, begin, end, *matched_prices, *matched_order_book,
+                               values.data() + task.offset + begin);
+        });
+    });
+    return values;
+}
+std::vector<StockAggregate> ResultRelation::collect_aggregates() {
+    std::vector<StockAggregate> aggregates;
+    for (auto& data : thread_data) {
+        if (data.aggregates.size() > aggregates.size()) {
+            aggregates.resize(data.aggregates.size());
+        }
+        for (size_t i = 0; i < data.aggregates.size(); ++i) {
+            aggregates[i].value_sum += data.aggregates[i].value_sum;
+            aggregates[i].amount_sum += data.aggregates[i].amount_sum;
+            aggregates[i].count += data.aggregates[i].count;
+        }
+    }
+    return aggregates;
+}
+
+void ResultRelation::print() {
+    /// A price only matches orders of its own stock, so the stock id is printed once.
+    std::cout
+        << "Price t, Price, "
+        << "OrderBook t, Stock, Amount, Value" << std::endl;
+
+    auto columns = gather();
+    for (size_t i = 0; i < columns.values.size(); ++i) {
+        std::cout
+            << columns.prices_timestamps[i] << ","
+            << columns.prices[i] << ","
+            << columns.order_book_timestamps[i] << ","
+            << columns.order_book_stock_ids[i] << ","
+            << columns.amounts[i] << ","
+            << columns.values[i] << std::endl;
+    }
+}
@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "result_writer.hpp"
+#include "columnar_file.hpp"
+#include "mmap_file.hpp"
+
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/parallel_for.h"
+
+
+namespace {
+    constexpr uint64_t POWERS_OF_TEN[20] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+        1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+        100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+        1000000000000000000ull, 10000000000000000000ull
+    };
+
+    constexpr char DIGIT_PAIRS[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    /// Number of decimal digits of [[value]], estimated from its bit length and corrected by one comparison.
+    [[gnu::always_inline]] inline size_t num_digits(uint64_t value) {
+        size_t estimate = static_cast<size_t>(std::bit_width(value | 1)) * 1233 >> 12;
+        return estimate + 1 - ((value | 1) < POWERS_OF_TEN[estimate]);
+    }
+
+    /// Write the [[digits]] decimal digits of [[value]] to [[out]], two digits at a time.
+    [[gnu::always_inline]] inline char* write_uint(char* out, uint64_t value, size_t digits) {
+        char* pos = out + digits;
+        while (value >= 100) {
+            pos -= 2;
+            std::memcpy(pos, DIGIT_PAIRS + (value % 100) * 2, 2);
+            value /= 100;
+        }
+        if (value >= 10) {
+            pos -= 2;
+            std::memcpy(pos, DIGIT_PAIRS + value * 2, 2);
+        } else {
+            *--pos = static_cast<char>('0' + value);
+        }
+        return out + digits;
+    }
+
+    /// Length of a nullable field, [[ResultRelation::NULL_VALUE]] is written as an empty field.
+    [[gnu::always_inline]] inline size_t field_size(uint64_t value) {
+        return value == ResultRelation::NULL_VALUE ? 0 : num_digits(value);
+    }
+
+    [[gnu::always_inline]] inline char* write_field(char* out, uint64_t value) {
+        return value == ResultRelation::NULL_VALUE ? out : write_uint(out, value, num_digits(value));
+    }
+
+    size_t csv_row_size(const ResultChunk& columns, size_t row) {
+        /// Five delimiters and the newline.
+        return 6 +
+            field_size(columns.prices_timestamps[row]) +
+            columns.order_book_stock_ids[row].size() +
+            field_size(columns.prices[row]) +
+            num_digits(columns.order_book_timestamps[row]) +
+            num_digits(columns.amounts[row]) +
+            field_size(columns.values[row]);
+    }
+
+    char* write_csv_row(char* out, const ResultChunk& columns, size_t row, char delimiter) {
+        out = write_field(out, columns.prices_timestamps[row]);
+        *out++ = delimiter;
+        const auto& stock_id = columns.order_book_stock_ids[row];
+        std::memcpy(out, stock_id.data(), stock_id.size());
+        out += stock_id.size();
+        *out++ = delimiter;
+        out = write_field(out, columns.prices[row]);
+        *out++ = delimiter;
+        out = write_field(out, columns.order_book_timestamps[row]);
+        *out++ = delimiter;
+        out = write_field(out, columns.amounts[row]);
+        *out++ = delimiter;
+        out = write_field(out, columns.values[row]);
+        *out++ = '\n';
+        return out;
+    }
+
+    size_t num_blocks(size_t num_rows) {
+        return (num_rows + result_writer::BLOCK_SIZE - 1) / result_writer::BLOCK_SIZE;
+    }
+
+    template<typename Func>
+    void for_each_block(size_t num_rows, Func&& func) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks(num_rows), 1),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t block = range.begin(); block < range.end(); ++block) {
+                size_t begin = block * result_writer::BLOCK_SIZE;
+                func(block, begin, std::min(num_rows, begin + result_writer::BLOCK_SIZE));
+            }
+        });
+    }
+
+    /// Buffer of every thread into which late materialized chunks are fetched, see [[ResultRelation::chunk_rows]].
+    class ChunkBuffers {
+    public:
+        const ResultChunk& rows(ResultRelation& result, const ResultChunkView& view) {
+            if (view.rows != nullptr) {
+                return *view.rows;
+            }
+            auto& buffer = buffers.local();
+            if (buffer == nullptr) {
+                buffer = std::make_unique_for_overwrite<ResultChunk>();
+            }
+            return result.chunk_rows(view, *buffer);
+        }
+
+    private:
+        tbb::enumerable_thread_specific<std::unique_ptr<ResultChunk>> buffers;
+    };
+
+    template<typename Func>
+    void for_each_chunk(const std::vector<ResultChunkView>& views, Func&& func) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, views.size(), 1),
+                [&](tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                func(i, views[i]);
+            }
+        });
+    }
+
+    size_t total_rows(const std::vector<ResultChunkView>& views) {
+        return views.empty() ? 0 : views.back().offset + views.back().num_rows;
+    }
+
+    size_t align_up(size_t offset) {
+        return (offset + columnar::SECTION_ALIGNMENT - 1) & ~(columnar::SECTION_ALIGNMENT - 1);
+    }
+
+    /// Output file of [[file_size]] bytes, which is closed on destruction.
+    class OutputFile {
+    public:
+        OutputFile(std::string_view path, size_t file_size): path(path) {
+            handle = ::open(this->path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (handle < 0) {
+                throw std::runtime_error("Failed to open " + this->path);
+            }
+            if (ftruncate(handle, static_cast<off_t>(file_size)) != 0) {
+                close(handle);
+                throw std::runtime_error("Failed to resize " + this->path);
+            }
+        }
+
+        OutputFile(const OutputFile& other) = delete;
+        OutputFile& operator=(const OutputFile& other) = delete;
+
+        ~OutputFile() {
+            close(handle);
+        }
+
+        /// Write [[size]] bytes at [[offset]]. Safe to call concurrently for disjoint ranges.
+        void write_at(const void* data, size_t size, size_t offset) const {
+            const char* bytes = static_cast<const char*>(data);
+            while (size > 0) {
+                ssize_t written = pwrite(handle, bytes, size, static_cast<off_t>(offset));
+                if (written <= 0) {
+                    throw std::runtime_error("Failed to write " + path);
+                }
+                bytes += written;
+                size -= written;
+                offset += written;
+            }
+        }
+
+        [[nodiscard]] int get_handle() const {
+            return handle;
+        }
+
+    private:
+        std::string path;
+        int handle;
+    };
+
+    std::string csv_header(char delimiter) {
+        std::string header;
+        for (std::string_view column : {"price_timestamp", "stock_id", "price",
+                                        "order_book_timestamp", "amount", "value"}) {
+            if (!header.empty()) {
+                header += delimiter;
+            }
+            header += column;
+        }
+        return header + '\n';
+    }
+} // namespace
+
+void result_writer::write_csv(ResultRelation& result, std::string_view path, char delimiter) {
+    const auto views = result.chunk_views();
+    const std::string header = csv_header(delimiter);
+    ChunkBuffers buffers;
+
+    /// Size every chunk first, such that each chunk formats directly into its region of the file.
+    /// Late materialized chunks are fetched in both passes instead of keeping them in memory.
+    std::vector<size_t> offsets(views.size() + 1, 0);
+    for_each_chunk(views, [&](size_t i, const ResultChunkView& view) {
+        const auto& rows = buffers.rows(result, view);
+        size_t chunk_size = 0;
+        for (size_t row = 0; row < view.num_rows; ++row) {
+            chunk_size += csv_row_size(rows, row);
+        }
+        offsets[i + 1] = chunk_size;
+    });
+
+    offsets[0] = header.size();
+    for (size_t i = 1; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i - 1];
+    }
+    const size_t file_size = offsets.back();
+
+    OutputFile file(path, file_size);
+    void* mapping = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, file.get_handle(), 0);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to mmap " + std::string(path));
+    }
+    char* data = static_cast<char*>(mapping);
+
+    std::memcpy(data, header.data(), header.size());
+    for_each_chunk(views, [&](size_t i, const ResultChunkView& view) {
+        const auto& rows = buffers.rows(result, view);
+        char* out = data + offsets[i];
+        for (size_t row = 0; row < view.num_rows; ++row) {
+            out = write_csv_row(out, rows, row, delimiter);
+        }
+    });
+
+    munmap(mapping, file_size);
+}
+
+void result_writer::write_binary(ResultRelation& result, std::string_view path) {
+    const auto views = result.chunk_views();
+    const size_t num_rows = total_rows(views);
+
+    ResultFileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.symbol_id_size = sizeof(SymbolId);
+    header.num_rows = num_rows;
+    size_t offset = align_up(sizeof(ResultFileHeader));
+    for (size_t i = 0; i < NUM_VALUE_COLUMNS; ++i) {
+        header.value_offsets[i] = offset;
+        offset = align_up(offset + num_rows * sizeof(uint64_t));
+    }
+    header.symbol_ids_offset = offset;
+    header.dictionary_offset = align_up(offset + num_rows * sizeof(SymbolId));
+
+    /// The size of the dictionary is only known after all symbol ids are written, it is appended last.
+    OutputFile file(path, header.dictionary_offset);
+    ChunkBuffers buffers;
+    tbb::enumerable_thread_specific<size_t> num_symbols_per_thread(0);
+    for_each_chunk(views, [&](size_t, const ResultChunkView& view) {
+        const auto& rows = buffers.rows(result, view);
+        const uint64_t* value_columns[NUM_VALUE_COLUMNS] = {
+            rows.prices_timestamps, rows.prices, rows.order_book_timestamps, rows.amounts, rows.values
+        };
+        for (size_t i = 0; i < NUM_VALUE_COLUMNS; ++i) {
+            file.write_at(value_columns[i], view.num_rows * sizeof(uint64_t),
+                          header.value_offsets[i] + view.offset * sizeof(uint64_t));
+        }
+
+        auto& num_symbols = num_symbols_per_thread.local();
+        for (size_t row = 0; row < view.num_rows; ++row) {
+            num_symbols = std::max<size_t>(num_symbols, rows.order_book_symbol_ids[row] + 1);
+        }
+        file.write_at(rows.order_book_symbol_ids, view.num_rows * sizeof(SymbolId),
+                      header.symbol_ids_offset + view.offset * sizeof(SymbolId));
+    });
+
+    size_t num_symbols = 0;
+    for (auto thread_num_symbols : num_symbols_per_thread) {
+        num_symbols = std::max(num_symbols, thread_num_symbols);
+    }
+    std::vector<uint64_t> symbol_offsets(num_symbols + 1, 0);
+    std::string symbol_bytes;
+    for (SymbolId id = 0; id < num_symbols; ++id) {
+        symbol_bytes += SymbolDictionary::shared().decode(id);
+        symbol_offsets[id + 1] = symbol_bytes.size();
+    }
+
+    header.num_symbols = num_symbols;
+    file.write_at(symbol_offsets.data(), symbol_offsets.size() * sizeof(uint64_t), header.dictionary_offset);
+    file.write_at(symbol_bytes.data(), symbol_bytes.size(),
+                  header.dictionary_offset + symbol_offsets.size() * sizeof(uint64_t));
+    file.write_at(&header, sizeof(ResultFileHeader), 0);
+}
+
+ResultColumns result_writer::read_binary(std::string_view path) {
+    MemoryMappedFile file(path);
+    const size_t file_size = file.file_size();
+    if (file_size < sizeof(ResultFileHeader)) {
+        throw std::runtime_error("Result file is too small " + std::string(path));
+    }
+
+    const auto* header = reinterpret_cast<const ResultFileHeader*>(file.begin());
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header->version != VERSION ||
+            header->symbol_id_size != sizeof(SymbolId) ||
+            header->symbol_ids_offset % alignof(SymbolId) != 0) {
+        throw std::runtime_error("Invalid result file header " + std::string(path));
+    }
+
+    const size_t num_rows = header->num_rows;
+    bool truncated = !file.fits(header->symbol_ids_offset, num_rows, sizeof(SymbolId));
+    for (size_t i = 0; i < NUM_VALUE_COLUMNS; ++i) {
+        truncated |= !file.fits(header->value_offsets[i], num_rows, sizeof(uint64_t));
+    }
+    if (truncated) {
+        throw std::runtime_error("Truncated result file " + std::string(path));
+    }
+
+    MappedDictionary dictionary(file, header->dictionary_offset, header->num_symbols,
+                                "result file " + std::string(path));
+    const size_t num_symbols = dictionary.size();
+
+    /// Translate the ids of the file into ids of the shared dictionary, which outlives the mapping.
+    std::vector<SymbolId> shared_ids(num_symbols);
+    std::vector<std::string_view> stock_ids(num_symbols);
+    for (size_t id = 0; id < num_symbols; ++id) {
+        std::tie(shared_ids[id], stock_ids[id]) = SymbolDictionary::shared().intern(dictionary.symbol(id));
+    }
+
+    ResultColumns columns;
+    std::vector<uint64_t>* value_columns[NUM_VALUE_COLUMNS] = {
+        &columns.prices_timestamps, &columns.prices, &columns.order_book_timestamps,
+        &columns.amounts, &columns.values
+    };
+    for (size_t i = 0; i < NUM_VALUE_COLUMNS; ++i) {
+        value_columns[i]->resize(num_rows);
+    }
+    columns.order_book_stock_ids.resize(num_rows);
+    columns.order_book_symbol_ids.resize(num_rows);
+
+    const auto* file_symbol_ids = reinterpret_cast<const SymbolId*>(file.begin() + header->symbol_ids_offset);
+    for_each_block(num_rows, [&](size_t block, size_t begin, size_t end) {
+        const size_t count = end - begin;
+        for (size_t i = 0; i < NUM_VALUE_COLUMNS; ++i) {
+            std::memcpy(value_columns[i]->data() + begin,
+                        file.begin() + header->value_offsets[i] + begin * sizeof(uint64_t),
+                        count * sizeof(uint64_t));
+        }
+        for (size_t row = begin; row < end; ++row) {
+            if (file_symbol_ids[row] >= stock_ids.size()) {
+                throw std::runtime_error("Invalid symbol id in result file");
+            }
+            columns.order_book_stock_ids[row] = stock_ids[file_symbol_ids[row]];
+            columns.order_book_symbol_ids[row] = shared_ids[file_symbol_ids[row]];
+        }
+    });
+
+    return columns;
+}
@@ -0,0 +1,104 @@
+#include <mutex>
+#include <unordered_set>
+#include "symbol_dictionary.hpp"
+
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+
+namespace {
+    constexpr SymbolId UNKNOWN_SYMBOL = UINT32_MAX;
+} // namespace
+
+SymbolId SymbolDictionary::insert_unlocked(std::string_view symbol) {
+    auto iter = ids.find(symbol);
+    if (iter != ids.end()) {
+        return iter->second;
+    }
+
+    auto id = static_cast<SymbolId>(symbols.size());
+    const auto& stored = symbols.emplace_back(symbol);
+    ids.emplace(stored, id);
+    return id;
+}
+
+SymbolId SymbolDictionary::encode(std::string_view symbol) {
+    return intern(symbol).first;
+}
+
+std::pair<SymbolId, std::string_view> SymbolDictionary::intern(std::string_view symbol) {
+    {
+        std::shared_lock lock(mutex);
+        auto iter = ids.find(symbol);
+        if (iter != ids.end()) {
+            return {iter->second, iter->first};
+        }
+    }
+
+    std::unique_lock lock(mutex);
+    auto id = insert_unlocked(symbol);
+    return {id, symbols[id]};
+}
+
+std::vector<SymbolId> SymbolDictionary::encode(const std::vector<std::string>& column) {
+    std::vector<SymbolId> result(column.size());
+    tbb::enumerable_thread_specific<std::unordered_set<std::string_view>> unknown_symbols;
+
+    /// Resolve all (or only the previously unknown) rows in parallel and collect the
+    /// distinct unknown symbols per thread. The lock is held across the parallel loop, so it runs
+    /// isolated: a waiting thread must not steal an outer task, e.g. of a concurrent encode, which
+    /// could block on the unique lock while this thread still holds the shared lock.
+    auto resolve = [&](bool collect_unknown) {
+        std::shared_lock lock(mutex);
+        tbb::this_task_arena::isolate([&] {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, column.size()),
+                    [&](tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++i) {
+                    if (!collect_unknown && result[i] != UNKNOWN_SYMBOL) {
+                        continue;
+                    }
+
+                    auto iter = ids.find(column[i]);
+                    if (iter != ids.end()) {
+                        result[i] = iter->second;
+                    } else {
+                        result[i] = UNKNOWN_SYMBOL;
+                        unknown_symbols.local().insert(column[i]);
+                    }
+                }
+            });
+        });
+    };
+
+    /// 1. Resolve all already known symbols.
+    resolve(/* collect_unknown= */ true);
+
+    if (unknown_symbols.empty()) {
+        return result;
+    }
+
+    /// 2. Insert the (few) distinct unknown symbols serially.
+    {
+        std::unique_lock lock(mutex);
+        for (auto& local_unknown : unknown_symbols) {
+            for (auto symbol : local_unknown) {
+                insert_unlocked(symbol);
+            }
+        }
+    }
+
+    /// 3. Resolve the remaining rows which are now all known.
+    resolve(/* collect_unknown= */ false);
+    return result;
+}
+
+std::string_view SymbolDictionary::decode(SymbolId id) const {
+    std::shared_lock lock(mutex);
+    return symbols[id];
+}
+
+size_t SymbolDictionary::size() const {
+    std::shared_lock lock(mutex);
+    return symbols.size();
+}
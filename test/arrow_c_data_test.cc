@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "arrow_c_data.hpp"
+#include "asof_join.hpp"
+#include "relation.hpp"
+
+
+TEST(arrow_c_data, ExportIsZeroCopy) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+
+    ArrowArray array;
+    ArrowSchema schema;
+    arrow_c::export_prices(prices, &array, &schema);
+    ASSERT_EQ(array.length, prices.size);
+    ASSERT_EQ(std::string_view(schema.format), "+s");
+
+    arrow_c::ImportedRelation relation(&array, &schema);
+    ASSERT_EQ(array.release, nullptr);
+    ASSERT_EQ(schema.release, nullptr);
+
+    ASSERT_EQ(relation.num_rows(), prices.size);
+    ASSERT_EQ(relation.timestamps().data(), prices.timestamps.data());
+    ASSERT_EQ(relation.values().data(), prices.prices.data());
+    for (size_t i = 0; i < prices.size; ++i) {
+        ASSERT_EQ(relation.stock_id(i), prices.stock_ids[i]) << "Failed at row " << i;
+    }
+}
+
+TEST(arrow_c_data, RoundTripOrderBook) {
+    OrderBook order_book = load_order_book("../test/data/orderbook_small.csv");
+
+    ArrowArray array;
+    ArrowSchema schema;
+    arrow_c::export_order_book(order_book, &array, &schema);
+    OrderBook imported = arrow_c::import_order_book(&array, &schema);
+
+    ASSERT_EQ(imported.size, order_book.size);
+    ASSERT_EQ(imported.timestamps, order_book.timestamps);
+    ASSERT_EQ(imported.stock_ids, order_book.stock_ids);
+    ASSERT_EQ(imported.symbol_ids, order_book.symbol_ids);
+    ASSERT_EQ(imported.amounts, order_book.amounts);
+}
+
+TEST(arrow_c_data, ImportSlicedArray) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+
+    ArrowArray array;
+    ArrowSchema schema;
+    arrow_c::export_prices(prices, &array, &schema);
+    array.offset = 2;
+    array.length -= 2;
+
+    Prices imported = arrow_c::import_prices(&array, &schema);
+    ASSERT_EQ(imported.size, prices.size - 2);
+    for (size_t i = 0; i < imported.size; ++i) {
+        ASSERT_EQ(imported.timestamps[i], prices.timestamps[i + 2]) << "Failed at row " << i;
+        ASSERT_EQ(imported.stock_ids[i], prices.stock_ids[i + 2]) << "Failed at row " << i;
+        ASSERT_EQ(imported.prices[i], prices.prices[i + 2]) << "Failed at row " << i;
+    }
+}
+
+TEST(arrow_c_data, RejectInvalidSchema) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+
+    ArrowArray array;
+    ArrowSchema schema;
+    arrow_c::export_prices(prices, &array, &schema);
+    schema.children[0]->format = "u";
+
+    ASSERT_THROW(arrow_c::import_prices(&array, &schema), std::runtime_error);
+    ASSERT_EQ(array.release, nullptr);
+    ASSERT_EQ(schema.release, nullptr);
+}
+
+TEST(arrow_c_data, ExportResult) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+    OrderBook order_book = load_order_book("../test/data/orderbook_small.csv");
+    SortingASOFJoin join(prices, order_book, LESS_EQUAL_THAN, INNER);
+    join.join();
+
+    ArrowArray array;
+    ArrowSchema schema;
+    arrow_c::export_result(join.result, &array, &schema);
+    ASSERT_EQ(array.length, join.result.size);
+    ASSERT_EQ(schema.n_children, 6);
+    const char* names[] = {"price_timestamp", "stock_id", "price", "order_book_timestamp", "amount", "value"};
+    for (int64_t i = 0; i < schema.n_children; ++i) {
+        ASSERT_EQ(std::string_view(schema.children[i]->name), names[i]);
+        ASSERT_EQ(array.children[i]->length, array.length);
+        ASSERT_EQ(array.children[i]->null_count, 0);
+    }
+
+    /// A child moved out of its parent stays valid after the parent is released.
+    ArrowArray values = *array.children[5];
+    array.children[5]->release = nullptr;
+    array.release(&array);
+    schema.release(&schema);
+
+    uint64_t value_sum = 0;
+    for (int64_t i = 0; i < values.length; ++i) {
+        value_sum += static_cast<const uint64_t*>(values.buffers[1])[i];
+    }
+    ASSERT_EQ(value_sum, join.result.value_sum);
+    values.release(&values);
+}
+
+TEST(arrow_c_data, ExportLeftOuterResult) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+    OrderBook order_book = load_order_book("../test/data/orderbook_small.csv");
+    PartitioningRightASOFJoin join(prices, order_book, LESS_EQUAL_THAN, LEFT);
+    join.join();
+    ASSERT_EQ(join.result.size, order_book.size);
+
+    ArrowArray array;
+    ArrowSchema schema;
+    arrow_c::export_result(join.result, &array, &schema);
+
+    /// The price timestamp, price and value of an unmatched order are null.
+    for (int64_t i : {0, 2, 5}) {
+        ASSERT_EQ(array.children[i]->null_count, join.result.num_unmatched);
+        ASSERT_EQ(schema.children[i]->flags, ARROW_FLAG_NULLABLE);
+    }
+    ASSERT_EQ(array.children[3]->null_count, 0);
+
+    const auto* values = array.children[5];
+    const auto* validity = static_cast<const uint8_t*>(values->buffers[0]);
+    int64_t num_valid = 0;
+    for (int64_t i = 0; i < values->length; ++i) {
+        num_valid += (validity[i / 8] >> (i % 8)) & 1;
+    }
+    ASSERT_EQ(num_valid, values->length - values->null_count);
+
+    array.release(&array);
+    schema.release(&schema);
+}
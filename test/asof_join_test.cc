@@ -1,4 +1,11 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+
+#include "fmt/format.h"
 
 #include "relation.hpp"
 #include "asof_join.hpp"
@@ -590,4 +597,452 @@ TEST(asof_join_partitioning_left_copy, TestSmallZipfExample) {
 
     ASSERT_EQ(join.result.size, 1024);
     ASSERT_EQ(join.result.value_sum, 2532396);
-}
\ No newline at end of file
+}
+namespace {
+    /// Prices with [[price_duplicates]] rows per timestamp and stock and orders hitting some of them exactly.
+    /// Orders of the last stock have no prices.
+    std::pair<Prices, OrderBook> generate_comparison_data(size_t num_prices, size_t num_orders, size_t num_stocks,
+                                                          size_t price_duplicates = 1) {
+        std::mt19937 rng(42);
+        std::vector<uint64_t> price_timestamps(num_prices), prices(num_prices);
+        std::vector<std::string> price_stock_ids(num_prices);
+        for (size_t i = 0; i < num_prices; ++i) {
+            price_timestamps[i] = (i / price_duplicates) * 7;
+            price_stock_ids[i] = fmt::format("s-{}", (i / price_duplicates) % num_stocks);
+            prices[i] = rng() % 100;
+        }
+
+        std::vector<uint64_t> order_timestamps(num_orders), amounts(num_orders);
+        std::vector<std::string> order_stock_ids(num_orders);
+        for (size_t i = 0; i < num_orders; ++i) {
+            order_timestamps[i] = rng() % 2 ? (rng() % num_prices) * 7 : rng() % (num_prices * 7 + 100);
+            order_stock_ids[i] = fmt::format("s-{}", rng() % (num_stocks + 1));
+            amounts[i] = rng() % 100;
+        }
+
+        Prices prices_rel(price_timestamps, price_stock_ids, prices, num_prices);
+        OrderBook order_book(order_timestamps, order_stock_ids, amounts, num_orders);
+        return {shuffle_prices(prices_rel), std::move(order_book)};
+    }
+
+    /// Reference result of [[comp]] as (number of rows, value sum).
+    std::pair<size_t, uint64_t> expected_comparison_result(
+            Prices& prices, OrderBook& order_book, Comparison comp, uint64_t max_lag) {
+        std::unordered_map<std::string, std::map<uint64_t, uint64_t>> prices_per_stock;
+        for (size_t i = 0; i < prices.size; ++i) {
+            prices_per_stock[prices.stock_ids[i]][prices.timestamps[i]] = prices.prices[i];
+        }
+
+        size_t num_rows = 0;
+        uint64_t value_sum = 0;
+        for (size_t i = 0; i < order_book.size; ++i) {
+            auto& stock_prices = prices_per_stock[order_book.stock_ids[i]];
+            auto timestamp = order_book.timestamps[i];
+            auto match = stock_prices.end();
+
+            switch (comp) {
+                case LESS_THAN:
+                    match = stock_prices.lower_bound(timestamp);
+                    match = match == stock_prices.begin() ? stock_prices.end() : std::prev(match);
+                    break;
+                case LESS_EQUAL_THAN:
+                    match = stock_prices.upper_bound(timestamp);
+                    match = match == stock_prices.begin() ? stock_prices.end() : std::prev(match);
+                    break;
+                case EQUAL:
+                    match = stock_prices.find(timestamp);
+                    break;
+                case GREATER_THAN:
+                    match = stock_prices.upper_bound(timestamp);
+                    break;
+                case GREATER_EQUAL_THEN:
+                    match = stock_prices.lower_bound(timestamp);
+                    break;
+                case NEAREST: {
+                    auto after = stock_prices.upper_bound(timestamp);
+                    match = after;
+                    if (after != stock_prices.begin()) {
+                        auto before = std::prev(after);
+                        if (after == stock_prices.end() ||
+                                timestamp - before->first <= after->first - timestamp) {
+                            match = before;
+                        }
+                    }
+                    break;
+                }
+            }
+
+            if (match != stock_prices.end() &&
+                    std::max(match->first, timestamp) - std::min(match->first, timestamp) <= max_lag) {
+                ++num_rows;
+                value_sum += match->second * order_book.amounts[i];
+            }
+        }
+        return {num_rows, value_sum};
+    }
+
+    template<typename Join>
+    void check_all_comparisons(JoinType join_type = INNER, uint64_t max_lag = ASOFJoin::NO_MAX_LAG,
+                               bool with_nearest = true, size_t num_stocks = 5) {
+        /// Bins are larger than a morsel to check the propagation of matches across chunks.
+        auto [prices, order_book] = generate_comparison_data(100'000, 200'000, num_stocks);
+
+        std::vector<Comparison> comparisons = {LESS_THAN, LESS_EQUAL_THAN, EQUAL, GREATER_THAN, GREATER_EQUAL_THEN};
+        if (with_nearest) {
+            comparisons.push_back(NEAREST);
+        }
+
+        for (auto comp : comparisons) {
+            auto [num_rows, value_sum] = expected_comparison_result(prices, order_book, comp, max_lag);
+            Join join(prices, order_book, comp, join_type, max_lag);
+            join.join();
+
+            if (join_type == LEFT) {
+                ASSERT_EQ(join.result.size, order_book.size) << "Failed for comparison " << comp;
+                ASSERT_EQ(join.result.num_unmatched, order_book.size - num_rows) << "Failed for comparison " << comp;
+            } else {
+                ASSERT_EQ(join.result.size, num_rows) << "Failed for comparison " << comp;
+                ASSERT_EQ(join.result.num_unmatched, 0) << "Failed for comparison " << comp;
+            }
+            ASSERT_EQ(join.result.value_sum, value_sum) << "Failed for comparison " << comp;
+        }
+    }
+
+    /// Rows of a result as (order timestamp, price timestamp, value) sorted for comparison.
+    std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> sorted_rows(ResultRelation& result) {
+        auto columns = result.gather();
+        std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> rows(columns.values.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            rows[i] = {columns.order_book_timestamps[i], columns.prices_timestamps[i], columns.values[i]};
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    template<typename Join>
+    void check_late_materialization(JoinType join_type, bool with_nearest = true) {
+        auto [prices, order_book] = generate_comparison_data(100'000, 200'000, 5);
+
+        std::vector<Comparison> comparisons = {LESS_EQUAL_THAN, GREATER_THAN};
+        if (with_nearest) {
+            comparisons.push_back(NEAREST);
+        }
+
+        for (auto comp : comparisons) {
+            Join eager(prices, order_book, comp, join_type, ASOFJoin::NO_MAX_LAG, EAGER);
+            eager.join();
+            Join late(prices, order_book, comp, join_type, ASOFJoin::NO_MAX_LAG, LATE);
+            late.join();
+
+            ASSERT_EQ(late.result.size, eager.result.size) << "Failed for comparison " << comp;
+            ASSERT_EQ(late.result.num_unmatched, eager.result.num_unmatched) << "Failed for comparison " << comp;
+            ASSERT_EQ(late.result.value_sum, eager.result.value_sum) << "Failed for comparison " << comp;
+            ASSERT_EQ(sorted_rows(late.result), sorted_rows(eager.result)) << "Failed for comparison " << comp;
+
+            auto eager_values = eager.result.collect_values();
+            auto late_values = late.result.collect_values();
+            std::sort(eager_values.begin(), eager_values.end());
+            std::sort(late_values.begin(), late_values.end());
+            ASSERT_EQ(late_values, eager_values) << "Failed for comparison " << comp;
+        }
+    }
+
+    template<typename Join>
+    void check_aggregation(JoinType join_type, bool with_nearest = true) {
+        auto [prices, order_book] = generate_comparison_data(100'000, 200'000, 5);
+
+        std::vector<Comparison> comparisons = {LESS_EQUAL_THAN, GREATER_THAN};
+        if (with_nearest) {
+            comparisons.push_back(NEAREST);
+        }
+
+        for (auto comp : comparisons) {
+            Join eager(prices, order_book, comp, join_type, ASOFJoin::NO_MAX_LAG, EAGER);
+            eager.join();
+            Join aggregating(prices, order_book, comp, join_type, ASOFJoin::NO_MAX_LAG, AGGREGATE);
+            aggregating.join();
+
+            ASSERT_EQ(aggregating.result.size, eager.result.size) << "Failed for comparison " << comp;
+            ASSERT_EQ(aggregating.result.num_unmatched, eager.result.num_unmatched) << "Failed for comparison " << comp;
+            ASSERT_EQ(aggregating.result.value_sum, eager.result.value_sum) << "Failed for comparison " << comp;
+            ASSERT_TRUE(aggregating.result.gather().values.empty()) << "Failed for comparison " << comp;
+
+            std::vector<StockAggregate> expected(SymbolDictionary::shared().size());
+            auto columns = eager.result.gather();
+            for (size_t i = 0; i < columns.values.size(); ++i) {
+                if (columns.values[i] == ResultRelation::NULL_VALUE) {
+                    continue;
+                }
+                auto& aggregate = expected[SymbolDictionary::shared().encode(columns.order_book_stock_ids[i])];
+                aggregate.value_sum += columns.values[i];
+                aggregate.amount_sum += columns.amounts[i];
+                ++aggregate.count;
+            }
+
+            auto aggregates = aggregating.result.collect_aggregates();
+            aggregates.resize(expected.size());
+            for (size_t id = 0; id < expected.size(); ++id) {
+                ASSERT_EQ(aggregates[id].value_sum, expected[id].value_sum) << "Failed for comparison " << comp;
+                ASSERT_EQ(aggregates[id].amount_sum, expected[id].amount_sum) << "Failed for comparison " << comp;
+                ASSERT_EQ(aggregates[id].count, expected[id].count) << "Failed for comparison " << comp;
+            }
+        }
+    }
+} // namespace
+
+TEST(asof_join_partitioning_left, TestAllComparisons) {
+    check_all_comparisons<PartitioningLeftASOFJoin>(INNER, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ false);
+}
+
+TEST(asof_join_partitioning_right, TestAllComparisons) {
+    check_all_comparisons<PartitioningRightASOFJoin>();
+}
+
+TEST(asof_join_partitioning_sort, TestAllComparisons) {
+    check_all_comparisons<PartitioningSortedMergeJoin>();
+}
+
+TEST(asof_join_partitioning_left, TestLeftOuterAllComparisons) {
+    check_all_comparisons<PartitioningLeftASOFJoin>(LEFT, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ false);
+}
+
+TEST(asof_join_partitioning_right, TestLeftOuterAllComparisons) {
+    check_all_comparisons<PartitioningRightASOFJoin>(LEFT);
+}
+
+TEST(asof_join_partitioning_sort, TestLeftOuterAllComparisons) {
+    check_all_comparisons<PartitioningSortedMergeJoin>(LEFT);
+}
+
+TEST(asof_join_partitioning_left, TestMaxLagAllComparisons) {
+    check_all_comparisons<PartitioningLeftASOFJoin>(INNER, /* max_lag= */ 20, /* with_nearest= */ false);
+    check_all_comparisons<PartitioningLeftASOFJoin>(LEFT, /* max_lag= */ 20, /* with_nearest= */ false);
+}
+
+TEST(asof_join_partitioning_right, TestMaxLagAllComparisons) {
+    check_all_comparisons<PartitioningRightASOFJoin>(INNER, /* max_lag= */ 20);
+    check_all_comparisons<PartitioningRightASOFJoin>(LEFT, /* max_lag= */ 20);
+}
+
+TEST(asof_join_partitioning_sort, TestMaxLagAllComparisons) {
+    check_all_comparisons<PartitioningSortedMergeJoin>(INNER, /* max_lag= */ 20);
+    check_all_comparisons<PartitioningSortedMergeJoin>(LEFT, /* max_lag= */ 20);
+}
+
+TEST(asof_join_partitioning_left, TestNearestUnsupported) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+    OrderBook order_book = load_order_book("../test/data/orderbook_small.csv");
+    PartitioningLeftASOFJoin join(prices, order_book, NEAREST, INNER);
+
+    ASSERT_THROW(join.join(), std::invalid_argument);
+}
+
+TEST(asof_join_partitioning_left, TestLateMaterialization) {
+    check_late_materialization<PartitioningLeftASOFJoin>(INNER, /* with_nearest= */ false);
+    check_late_materialization<PartitioningLeftASOFJoin>(LEFT, /* with_nearest= */ false);
+}
+
+TEST(asof_join_partitioning_right, TestLateMaterialization) {
+    check_late_materialization<PartitioningRightASOFJoin>(INNER);
+    check_late_materialization<PartitioningRightASOFJoin>(LEFT);
+}
+
+TEST(asof_join_partitioning_sort, TestLateMaterialization) {
+    check_late_materialization<PartitioningSortedMergeJoin>(INNER);
+    check_late_materialization<PartitioningSortedMergeJoin>(LEFT);
+}
+
+TEST(asof_join_partitioning_left, TestAggregation) {
+    check_aggregation<PartitioningLeftASOFJoin>(INNER, /* with_nearest= */ false);
+    check_aggregation<PartitioningLeftASOFJoin>(LEFT, /* with_nearest= */ false);
+}
+
+TEST(asof_join_partitioning_right, TestAggregation) {
+    check_aggregation<PartitioningRightASOFJoin>(INNER);
+    check_aggregation<PartitioningRightASOFJoin>(LEFT);
+}
+
+TEST(asof_join_partitioning_sort, TestAggregation) {
+    check_aggregation<PartitioningSortedMergeJoin>(INNER);
+    check_aggregation<PartitioningSortedMergeJoin>(LEFT);
+}
+
+TEST(asof_join_adaptive, TestSmallDuckDBExample) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+    OrderBook order_book = load_order_book("../test/data/orderbook_small.csv");
+    AdaptiveASOFJoin join(prices, order_book, LESS_EQUAL_THAN, INNER);
+    join.join();
+
+    ASSERT_EQ(join.result.size, 4);
+    ASSERT_EQ(join.result.value_sum, 9581);
+}
+
+TEST(asof_join_adaptive, TestAllComparisons) {
+    check_all_comparisons<AdaptiveASOFJoin>();
+    check_all_comparisons<AdaptiveASOFJoin>(LEFT);
+    check_all_comparisons<AdaptiveASOFJoin>(INNER, /* max_lag= */ 20);
+}
+
+/// Equal price timestamps carry different prices, so all kernels have to match the same one of them.
+namespace {
+    void check_duplicate_price_timestamps(Prices& prices, OrderBook& order_book) {
+        for (auto comp : {EQUAL, LESS_EQUAL_THAN, GREATER_EQUAL_THEN}) {
+            auto [num_rows, value_sum] = expected_comparison_result(prices, order_book, comp, ASOFJoin::NO_MAX_LAG);
+            PartitioningRightASOFJoin right(prices, order_book, comp, INNER);
+            right.join();
+            ASSERT_EQ(right.result.size, num_rows) << "Failed for comparison " << comp;
+            auto expected_rows = sorted_rows(right.result);
+
+            PartitioningSortedMergeJoin sorted_merge(prices, order_book, comp, INNER);
+            sorted_merge.join();
+            ASSERT_EQ(sorted_rows(sorted_merge.result), expected_rows) << "Failed for comparison " << comp;
+
+            PartitioningLeftASOFJoin left(prices, order_book, comp, INNER);
+            left.join();
+            ASSERT_EQ(sorted_rows(left.result), expected_rows) << "Failed for comparison " << comp;
+
+            AdaptiveASOFJoin adaptive(prices, order_book, comp, INNER);
+            adaptive.join();
+            ASSERT_EQ(sorted_rows(adaptive.result), expected_rows) << "Failed for comparison " << comp;
+        }
+    }
+} // namespace
+
+TEST(asof_join_adaptive, TestDuplicatePriceTimestamps) {
+    auto [prices, order_book] = generate_comparison_data(100'000, 200'000, 5, /* price_duplicates= */ 3);
+    check_duplicate_price_timestamps(prices, order_book);
+}
+
+/// Bins below the minimal radix sort size are sorted by comparisons, which must keep the duplicates in order, too.
+TEST(asof_join_adaptive, TestDuplicatePriceTimestampsSmallBins) {
+    auto [prices, order_book] = generate_comparison_data(200, 2'000, 1, /* price_duplicates= */ 10);
+    check_duplicate_price_timestamps(prices, order_book);
+}
+
+TEST(asof_join_adaptive, TestChooseStrategy) {
+    JoinEstimates estimates{};
+    estimates.num_stocks = 1000;
+    estimates.num_prices = 1'000;
+    estimates.num_orders = 100'000'000;
+    ASSERT_EQ(AdaptiveASOFJoin::choose_strategy(estimates, LESS_EQUAL_THAN, LEFT, ASOFJoin::NO_MAX_LAG, EAGER),
+              AdaptiveASOFJoin::PARTITION_RIGHT);
+
+    /// Skipping the orders before all prices only pays off for the default query.
+    estimates.orders_before_prices = 0.5;
+    ASSERT_EQ(AdaptiveASOFJoin::choose_strategy(estimates, LESS_EQUAL_THAN, INNER, ASOFJoin::NO_MAX_LAG, EAGER),
+              AdaptiveASOFJoin::PARTITION_RIGHT_FILTER_MIN);
+    ASSERT_EQ(AdaptiveASOFJoin::choose_strategy(estimates, LESS_EQUAL_THAN, INNER, ASOFJoin::NO_MAX_LAG, LATE),
+              AdaptiveASOFJoin::PARTITION_RIGHT);
+
+    estimates.num_prices = 100'000'000;
+    estimates.num_orders = 1'000;
+    ASSERT_EQ(AdaptiveASOFJoin::choose_strategy(estimates, LESS_EQUAL_THAN, INNER, ASOFJoin::NO_MAX_LAG, EAGER),
+              AdaptiveASOFJoin::PARTITION_LEFT);
+    ASSERT_NE(AdaptiveASOFJoin::choose_strategy(estimates, NEAREST, INNER, ASOFJoin::NO_MAX_LAG, EAGER),
+              AdaptiveASOFJoin::PARTITION_LEFT);
+
+    estimates.num_orders = 100'000'000;
+    ASSERT_EQ(AdaptiveASOFJoin::choose_strategy(estimates, LESS_EQUAL_THAN, INNER, ASOFJoin::NO_MAX_LAG, EAGER),
+              AdaptiveASOFJoin::PARTITION_SORTED_MERGE);
+
+    /// Within the max lag of no price, the orders skip their searches.
+    estimates.min_price_timestamp = 0;
+    estimates.max_price_timestamp = 1'000;
+    estimates.min_order_timestamp = 1'000'000;
+    estimates.max_order_timestamp = 2'000'000;
+    ASSERT_EQ(AdaptiveASOFJoin::choose_strategy(estimates, LESS_EQUAL_THAN, INNER, ASOFJoin::NO_MAX_LAG, EAGER),
+              AdaptiveASOFJoin::PARTITION_SORTED_MERGE);
+    ASSERT_EQ(AdaptiveASOFJoin::choose_strategy(estimates, LESS_EQUAL_THAN, INNER, 10, EAGER),
+              AdaptiveASOFJoin::PARTITION_RIGHT);
+}
+
+TEST(asof_join_adaptive, TestEstimate) {
+    auto [prices, order_book] = generate_comparison_data(100'000, 200'000, 5);
+    auto estimates = AdaptiveASOFJoin::estimate(prices, order_book);
+
+    ASSERT_EQ(estimates.num_prices, prices.size);
+    ASSERT_EQ(estimates.num_orders, order_book.size);
+    ASSERT_EQ(estimates.num_stocks, 6);
+    ASSERT_EQ(estimates.min_price_timestamp, 0);
+    ASSERT_EQ(estimates.max_price_timestamp, (prices.size - 1) * 7);
+    ASSERT_EQ(estimates.min_order_timestamp, *std::min_element(order_book.timestamps.begin(), order_book.timestamps.end()));
+    ASSERT_EQ(estimates.orders_before_prices, 0.0);
+}
+
+/// A single stock holds most orders, so its bins are split into multiple time ranges.
+TEST(asof_join_partitioning_left, TestSkewedAllComparisons) {
+    check_all_comparisons<PartitioningLeftASOFJoin>(LEFT, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ false,
+                                                    /* num_stocks= */ 1);
+}
+
+TEST(asof_join_partitioning_right, TestSkewedAllComparisons) {
+    check_all_comparisons<PartitioningRightASOFJoin>(LEFT, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ true,
+                                                     /* num_stocks= */ 1);
+}
+
+TEST(asof_join_partitioning_sort, TestSkewedAllComparisons) {
+    check_all_comparisons<PartitioningSortedMergeJoin>(INNER, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ true,
+                                                       /* num_stocks= */ 1);
+    check_all_comparisons<PartitioningSortedMergeJoin>(LEFT, /* max_lag= */ 20, /* with_nearest= */ true,
+                                                       /* num_stocks= */ 1);
+}
+
+TEST(asof_join_partitioning_left_batched, TestAllComparisons) {
+    check_all_comparisons<PartitioningLeftBatchedASOFJoin>(INNER, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ false);
+    check_all_comparisons<PartitioningLeftBatchedASOFJoin>(LEFT, /* max_lag= */ 20, /* with_nearest= */ false);
+    check_all_comparisons<PartitioningLeftBatchedASOFJoin>(LEFT, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ false,
+                                                           /* num_stocks= */ 1);
+}
+
+TEST(asof_join_partitioning_right_batched, TestAllComparisons) {
+    check_all_comparisons<PartitioningRightBatchedASOFJoin>();
+    check_all_comparisons<PartitioningRightBatchedASOFJoin>(LEFT, /* max_lag= */ 20);
+    check_all_comparisons<PartitioningRightBatchedASOFJoin>(LEFT, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ true,
+                                                            /* num_stocks= */ 1);
+}
+
+TEST(asof_join_partitioning_left_interleaved, TestAllComparisons) {
+    check_all_comparisons<PartitioningLeftInterleavedASOFJoin>(INNER, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ false);
+    check_all_comparisons<PartitioningLeftInterleavedASOFJoin>(LEFT, /* max_lag= */ 20, /* with_nearest= */ false);
+}
+
+TEST(asof_join_partitioning_right_interleaved, TestAllComparisons) {
+    check_all_comparisons<PartitioningRightInterleavedASOFJoin>();
+    check_all_comparisons<PartitioningRightInterleavedASOFJoin>(LEFT, /* max_lag= */ 20);
+}
+
+/// A single stock makes the bins large enough for an Eytzinger layout.
+TEST(asof_join_partitioning_left_eytzinger, TestAllComparisons) {
+    check_all_comparisons<PartitioningLeftEytzingerASOFJoin>(INNER, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ false,
+                                                             /* num_stocks= */ 1);
+    check_all_comparisons<PartitioningLeftEytzingerASOFJoin>(LEFT, /* max_lag= */ 20, /* with_nearest= */ false,
+                                                             /* num_stocks= */ 1);
+}
+
+TEST(asof_join_partitioning_right_eytzinger, TestAllComparisons) {
+    check_all_comparisons<PartitioningRightEytzingerASOFJoin>(INNER, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ true,
+                                                              /* num_stocks= */ 1);
+    check_all_comparisons<PartitioningRightEytzingerASOFJoin>(LEFT, /* max_lag= */ 20, /* with_nearest= */ true,
+                                                              /* num_stocks= */ 1);
+}
+
+TEST(asof_join_partitioning_right_kary, TestAllComparisons) {
+    check_all_comparisons<PartitioningRightKAryASOFJoin>(INNER, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ true,
+                                                         /* num_stocks= */ 1);
+    check_all_comparisons<PartitioningRightKAryASOFJoin>(LEFT, /* max_lag= */ 20, /* with_nearest= */ true,
+                                                         /* num_stocks= */ 1);
+}
+
+TEST(asof_join_partitioning_left_learned, TestAllComparisons) {
+    check_all_comparisons<PartitioningLeftLearnedASOFJoin>(INNER, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ false,
+                                                           /* num_stocks= */ 1);
+    check_all_comparisons<PartitioningLeftLearnedASOFJoin>(LEFT, /* max_lag= */ 20, /* with_nearest= */ false,
+                                                           /* num_stocks= */ 1);
+}
+
+TEST(asof_join_partitioning_right_learned, TestAllComparisons) {
+    check_all_comparisons<PartitioningRightLearnedASOFJoin>(INNER, ASOFJoin::NO_MAX_LAG, /* with_nearest= */ true,
+                                                            /* num_stocks= */ 1);
+    check_all_comparisons<PartitioningRightLearnedASOFJoin>(LEFT, /* max_lag= */ 20, /* with_nearest= */ true,
+                                                            /* num_stocks= */ 1);
+}
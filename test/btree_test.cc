@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -144,3 +145,27 @@ TEST(btree, FindGap) {
     ASSERT_TRUE(res_geq != nullptr);
     ASSERT_EQ(res_geq->key, capacity + 1);
 }
+
+TEST(btree, DuplicatesAcrossLeaves) {
+    /// Runs of equal keys span several leaves and inner nodes of trees with one to four levels.
+    for (size_t num_entries : {1, 7, 8, 9, 63, 64, 65, 513, 5000}) {
+        auto data = std::vector<TestEntry>{};
+        for (size_t i = 0; i < num_entries; ++i) {
+            data.emplace_back(2 * (i / 11) + 1, i);
+        }
+
+        auto tree = Btree<TestEntry>(data);
+        for (uint64_t target = 0; target <= data.back().key + 1; ++target) {
+            auto upper = std::upper_bound(data.begin(), data.end(), target,
+                [](uint64_t value, const TestEntry& entry) { return value < entry.key; });
+            auto lower = std::lower_bound(data.begin(), data.end(), target,
+                [](const TestEntry& entry, uint64_t value) { return entry.key < value; });
+            auto* expected_leq = upper == data.begin() ? nullptr : &*(upper - 1);
+            auto* expected_geq = lower == data.end() ? nullptr : &*lower;
+            ASSERT_EQ(tree.find_less_equal_than(target), expected_leq)
+                << fmt::format("For size {} and target {}", num_entries, target);
+            ASSERT_EQ(tree.find_greater_equal_than(target), expected_geq)
+                << fmt::format("For size {} and target {}", num_entries, target);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "columnar_file.hpp"
+#include "relation.hpp"
+
+
+TEST(columnar_file, RoundTripPrices) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+    std::string path = "/tmp/asof_join_columnar_test_prices.col";
+    columnar::write_prices(path, prices);
+
+    columnar::ColumnarFile file(path);
+    ASSERT_EQ(file.num_rows(), prices.size);
+    for (size_t i = 0; i < prices.size; ++i) {
+        ASSERT_EQ(file.timestamps()[i], prices.timestamps[i]) << "Failed at row " << i;
+        ASSERT_EQ(file.values()[i], prices.prices[i]) << "Failed at row " << i;
+        ASSERT_EQ(file.symbol(file.symbol_ids()[i]), prices.stock_ids[i]) << "Failed at row " << i;
+    }
+
+    Prices loaded = load_prices(path);
+    ASSERT_EQ(loaded.size, prices.size);
+    ASSERT_EQ(loaded.timestamps, prices.timestamps);
+    ASSERT_EQ(loaded.stock_ids, prices.stock_ids);
+    ASSERT_EQ(loaded.symbol_ids, prices.symbol_ids);
+    ASSERT_EQ(loaded.prices, prices.prices);
+    std::remove(path.c_str());
+}
+
+TEST(columnar_file, RoundTripOrderBook) {
+    OrderBook order_book = load_order_book("../test/data/orderbook_small.csv");
+    std::string path = "/tmp/asof_join_columnar_test_order_book.col";
+    columnar::write_order_book(path, order_book);
+
+    OrderBook loaded = columnar::load_order_book(path);
+    ASSERT_EQ(loaded.size, order_book.size);
+    ASSERT_EQ(loaded.timestamps, order_book.timestamps);
+    ASSERT_EQ(loaded.stock_ids, order_book.stock_ids);
+    ASSERT_EQ(loaded.symbol_ids, order_book.symbol_ids);
+    ASSERT_EQ(loaded.amounts, order_book.amounts);
+    std::remove(path.c_str());
+}
+
+TEST(columnar_file, RejectInvalidFile) {
+    std::string path = "/tmp/asof_join_columnar_test_invalid.col";
+    {
+        std::ofstream out(path);
+        out << "timestamp,stock_id,price\n1,s-1,2\n" << std::string(128, '0');
+    }
+
+    ASSERT_THROW(columnar::ColumnarFile file(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(columnar_file, RejectCorruptFile) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+    std::string path = "/tmp/asof_join_columnar_test_corrupt.col";
+    columnar::write_prices(path, prices);
+
+    columnar::ColumnarHeader header{};
+    {
+        std::ifstream in(path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+    auto patch = [&](size_t offset, auto value) {
+        std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(offset));
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    /// A symbol id outside the dictionary of the file.
+    patch(header.symbol_ids_offset, static_cast<SymbolId>(header.num_symbols));
+    ASSERT_NO_THROW(columnar::ColumnarFile file(path));
+    ASSERT_THROW(columnar::load_prices(path), std::runtime_error);
+
+    /// The second symbol ends before it starts.
+    patch(header.dictionary_offset + sizeof(uint64_t), uint64_t{100});
+    ASSERT_THROW(columnar::ColumnarFile file(path), std::runtime_error);
+
+    /// A row count whose column size overflows.
+    patch(offsetof(columnar::ColumnarHeader, num_rows), UINT64_MAX / 4);
+    ASSERT_THROW(columnar::ColumnarFile file(path), std::runtime_error);
+    std::remove(path.c_str());
+}
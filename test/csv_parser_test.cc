@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "fmt/format.h"
+
+#include "csv_parser.hpp"
+
+namespace {
+    /// Pad the buffer in front such that the SIMD parser may read 16 bytes before each field.
+    const std::string PADDING(16, 'x');
+} // namespace
+
+TEST(csv_parser, ParseUint64AllLengths) {
+    if (!csv::avx2_supported()) {
+        GTEST_SKIP() << "AVX2 not supported";
+    }
+
+    uint64_t value = 0;
+    for (size_t len = 1; len <= 19; ++len) {
+        value = value * 10 + (len % 10);
+        std::string buffer = PADDING + std::to_string(value) + ",";
+        std::string_view field(buffer.data() + PADDING.size(), len);
+
+        ASSERT_EQ(csv::parse_uint64_simd(buffer.data(), field), value) << "Failed at length " << len;
+    }
+
+    std::string buffer = PADDING + "18446744073709551615";
+    std::string_view field(buffer.data() + PADDING.size(), 20);
+    ASSERT_EQ(csv::parse_uint64_simd(buffer.data(), field), UINT64_MAX);
+}
+
+TEST(csv_parser, ParseUint64WithoutPadding) {
+    if (!csv::avx2_supported()) {
+        GTEST_SKIP() << "AVX2 not supported";
+    }
+
+    std::string buffer = "978307200,APPL";
+    std::string_view field(buffer.data(), 9);
+    ASSERT_EQ(csv::parse_uint64_simd(buffer.data(), field), 978307200);
+}
+
+TEST(csv_parser, ParseUint64Invalid) {
+    if (!csv::avx2_supported()) {
+        GTEST_SKIP() << "AVX2 not supported";
+    }
+
+    /// Invalid fields behave exactly like the scalar parser.
+    std::string buffer = PADDING + "12a4";
+    std::string_view field(buffer.data() + PADDING.size(), 4);
+    ASSERT_EQ(csv::parse_uint64_simd(buffer.data(), field), csv::string_view_to_uint64_t(field));
+
+    std::string long_buffer = PADDING + "1x34567890123456789";
+    std::string_view long_field(long_buffer.data() + PADDING.size(), 19);
+    ASSERT_EQ(csv::parse_uint64_simd(long_buffer.data(), long_field), 1);
+
+    std::string invalid_buffer = PADDING + "a124";
+    std::string_view invalid_field(invalid_buffer.data() + PADDING.size(), 4);
+    ASSERT_THROW(csv::parse_uint64_simd(invalid_buffer.data(), invalid_field), std::runtime_error);
+}
+
+TEST(csv_parser, Avx2MatchesScalar) {
+    if (!csv::avx2_supported()) {
+        GTEST_SKIP() << "AVX2 not supported";
+    }
+
+    std::string buffer = "time,stock,price\n";
+    for (size_t i = 0; i < 1000; ++i) {
+        buffer += fmt::format("{},s-{},{}\n", 1'700'000'000'000 + i * 997, i % 13, i * i);
+    }
+    /// Last row without a trailing newline.
+    buffer += "42,s-0,7";
+
+    csv::Columns scalar;
+    csv::parse_rows_scalar(buffer.data(), buffer.data() + buffer.size(), ',', true, scalar);
+    csv::Columns simd;
+    csv::parse_rows_avx2(buffer.data(), buffer.data(), buffer.data() + buffer.size(), ',', true, simd);
+
+    ASSERT_EQ(scalar.timestamps.size(), 1001);
+    ASSERT_EQ(simd.timestamps, scalar.timestamps);
+    ASSERT_EQ(simd.stock_ids, scalar.stock_ids);
+    ASSERT_EQ(simd.values, scalar.values);
+}
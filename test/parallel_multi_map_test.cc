@@ -1,9 +1,13 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
+#include <random>
 #include <vector>
 
 #include "asof_join.hpp"
 #include "parallel_multi_map.hpp"
+#include "radix_partition.hpp"
+#include "radix_sort.hpp"
 #include "fmt/format.h"
 #include "tbb/global_control.h"
 
@@ -140,3 +144,191 @@ TEST(multimap, Benchmark) {
     }
 
 }
+
+TEST(multimap, SymbolIdKeys) {
+    size_t num_keys = 4096;
+    size_t num_entries_per_key = 100;
+
+    std::vector<SymbolId> keys;
+    std::vector<uint64_t> values;
+    for (size_t i = 0; i < num_keys * num_entries_per_key; ++i) {
+        keys.push_back(i % num_keys);
+        values.push_back(i);
+    }
+
+    MultiMapTB<TestEntry, SymbolId> multi_map(keys, values);
+    for (SymbolId key = 0; key < num_keys; ++key) {
+        auto* data = multi_map.find(key);
+        ASSERT_TRUE(data != nullptr);
+        ASSERT_EQ(data->size(), num_entries_per_key);
+        std::sort(data->begin(), data->end());
+        for (size_t j = 0; j < num_entries_per_key; ++j) {
+            size_t correct_value = /* offset= */ key + j * num_keys;
+            ASSERT_EQ((*data)[j].timestamp, correct_value) << fmt::format("Failed at key {}, j={}", key, j);
+            ASSERT_EQ((*data)[j].idx, correct_value) << fmt::format("Failed at key {}, j={}", key, j);
+        }
+    }
+    ASSERT_TRUE(multi_map.find(num_keys) == nullptr);
+}
+
+TEST(multimap, RadixPartitionIsStable) {
+    /// Enough rows for multiple scatter chunks and partially filled write-combining buffers.
+    size_t num_entries = 300'007;
+    std::mt19937 rng(7);
+    std::vector<SymbolId> keys(num_entries);
+    std::vector<uint64_t> values(num_entries);
+    for (size_t i = 0; i < num_entries; ++i) {
+        keys[i] = rng() % 5'000;
+        values[i] = rng();
+    }
+
+    auto partitioned = radix::partition(keys, values, /* shift= */ 4, /* fanout= */ (5'000 >> 4) + 1);
+    const auto& offsets = partitioned.partition_offsets;
+    ASSERT_EQ(offsets.back(), num_entries);
+
+    for (size_t p = 0; p + 1 < offsets.size(); ++p) {
+        for (size_t i = offsets[p]; i < offsets[p + 1]; ++i) {
+            const auto& tuple = partitioned.tuples[i];
+            ASSERT_EQ(keys[tuple.idx] >> 4, p);
+            ASSERT_EQ(tuple.value, values[tuple.idx]);
+            if (i > offsets[p]) {
+                ASSERT_LT(partitioned.tuples[i - 1].idx, tuple.idx);
+            }
+        }
+    }
+}
+
+TEST(multimap, RadixSortIsStable) {
+    /// Sequential and parallel passes, with constant low digits and many duplicate keys.
+    for (size_t num_entries : {100, 5'000, 200'000}) {
+        std::mt19937 rng(num_entries);
+        std::vector<TestEntry> entries;
+        for (size_t i = 0; i < num_entries; ++i) {
+            entries.emplace_back(1'700'000'000'000 + (rng() % 20'000) * 256, i);
+        }
+
+        auto expected = entries;
+        std::stable_sort(expected.begin(), expected.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.timestamp < rhs.timestamp;
+        });
+        radix::sort(entries.begin(), entries.end());
+
+        for (size_t i = 0; i < num_entries; ++i) {
+            ASSERT_EQ(entries[i].timestamp, expected[i].timestamp) << fmt::format("Failed at {}", i);
+            ASSERT_EQ(entries[i].idx, expected[i].idx) << fmt::format("Failed at {}", i);
+        }
+    }
+}
+
+TEST(multimap, SymbolIdKeysIterateNonEmptyBins) {
+    /// Key 1 has no entries and must be skipped while iterating.
+    std::vector<SymbolId> keys{0, 2, 2, 5};
+    std::vector<uint64_t> values{10, 20, 30, 40};
+
+    MultiMapTB<TestEntry, SymbolId> multi_map(keys, values, /* num_partitions= */ 2);
+
+    std::vector<SymbolId> visited;
+    size_t num_entries = 0;
+    for (auto& [key, bin] : multi_map) {
+        visited.push_back(key);
+        num_entries += bin.size();
+    }
+
+    ASSERT_EQ(visited, (std::vector<SymbolId>{0, 2, 5}));
+    ASSERT_EQ(num_entries, keys.size());
+    ASSERT_EQ(multi_map.size(), 3);
+    ASSERT_FALSE(multi_map.contains(1));
+    ASSERT_FALSE(multi_map.contains(6));
+    ASSERT_EQ(multi_map[2].size(), 2);
+}
+
+TEST(multimap, SortBinsSplitsHeavyBins) {
+    /// Key 0 holds most entries, including many duplicate timestamps.
+    size_t num_entries = 200'000;
+    std::mt19937 rng(42);
+    std::vector<SymbolId> keys(num_entries);
+    std::vector<uint64_t> values(num_entries);
+    for (size_t i = 0; i < num_entries; ++i) {
+        keys[i] = i % 10 == 0 ? 1 + i % 3 : 0;
+        values[i] = rng() % 50'000;
+    }
+
+    MultiMapTB<TestEntry, SymbolId> multi_map(keys, values);
+    auto ranges = multi_map.sort_bins(/* max_range_size= */ 10'000);
+
+    std::vector<std::vector<std::pair<size_t, size_t>>> ranges_per_key(4);
+    for (auto& range : ranges) {
+        ASSERT_LT(range.begin, range.end);
+        ranges_per_key[range.key].emplace_back(range.begin, range.end);
+    }
+    ASSERT_GT(ranges_per_key[0].size(), 10);
+    ASSERT_EQ(ranges_per_key[1].size(), 1);
+
+    for (SymbolId key = 0; key < 4; ++key) {
+        auto& bin = multi_map[key];
+        auto& key_ranges = ranges_per_key[key];
+        std::sort(key_ranges.begin(), key_ranges.end());
+
+        /// The ranges cover the bin without gaps and the bin is sorted as a whole.
+        size_t expected_begin = 0;
+        for (auto [begin, end] : key_ranges) {
+            ASSERT_EQ(begin, expected_begin);
+            expected_begin = end;
+        }
+        ASSERT_EQ(expected_begin, bin.size());
+        ASSERT_TRUE(std::is_sorted(bin.begin(), bin.end())) << "Failed at key " << key;
+
+        for (auto& entry : bin) {
+            ASSERT_EQ(keys[entry.idx], key);
+            ASSERT_EQ(values[entry.idx], entry.timestamp);
+        }
+    }
+}
+
+TEST(multimap, SortBinsMergesPresortedBins) {
+    /// Key 0 is time ordered and heavy, key 1 consists of three ascending runs
+    /// with duplicates across the runs, and key 2 is unordered.
+    size_t num_entries = 100'000;
+    std::mt19937 rng(3);
+    std::vector<SymbolId> keys(num_entries);
+    std::vector<uint64_t> values(num_entries);
+    for (size_t i = 0; i < num_entries; ++i) {
+        keys[i] = i % 4 == 0 ? 1 : (i % 4 == 1 ? 2 : 0);
+        if (keys[i] == 0) {
+            values[i] = i / 8;
+        } else if (keys[i] == 1) {
+            values[i] = (i % (num_entries / 3)) / 2;
+        } else {
+            values[i] = rng() % 10'000;
+        }
+    }
+
+    MultiMapTB<TestEntry, SymbolId> multi_map(keys, values);
+    auto expected_bin_0 = multi_map[0];
+    auto ranges = multi_map.sort_bins(/* max_range_size= */ 10'000);
+
+    size_t num_ranges_0 = 0;
+    for (auto& range : ranges) {
+        if (range.key == 0) {
+            ++num_ranges_0;
+            /// Equal timestamps are never cut into different ranges.
+            ASSERT_TRUE(range.begin == 0 ||
+                multi_map[0][range.begin - 1].timestamp < multi_map[0][range.begin].timestamp);
+        }
+    }
+    ASSERT_GT(num_ranges_0, 1);
+
+    for (SymbolId key = 0; key < 3; ++key) {
+        auto& bin = multi_map[key];
+        ASSERT_TRUE(std::is_sorted(bin.begin(), bin.end())) << "Failed at key " << key;
+        for (size_t i = 1; key != 2 && i < bin.size(); ++i) {
+            /// Merging keeps the row order of equal timestamps.
+            if (bin[i - 1].timestamp == bin[i].timestamp) {
+                ASSERT_LT(bin[i - 1].idx, bin[i].idx) << "Failed at key " << key;
+            }
+        }
+    }
+    for (size_t i = 0; i < expected_bin_0.size(); ++i) {
+        ASSERT_EQ(multi_map[0][i].idx, expected_bin_0[i].idx);
+    }
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "fmt/format.h"
+
+#include "relation.hpp"
+
+#include "tbb/parallel_for.h"
+
+namespace {
+    /// Write a csv with [[num_rows]] rows which spans multiple loader chunks.
+    std::string write_csv(size_t num_rows, bool header, bool trailing_newline) {
+        std::string path = fmt::format("/tmp/asof_join_relation_test_{}_{}_{}.csv",
+                                       num_rows, header, trailing_newline);
+        std::ofstream out(path);
+        if (header) {
+            out << "timestamp,stock_id,price\n";
+        }
+        for (size_t i = 0; i < num_rows; ++i) {
+            out << i * 3 << ",s-" << i % 17 << "," << i % 1000;
+            if (i + 1 < num_rows || trailing_newline) {
+                out << "\n";
+            }
+        }
+        return path;
+    }
+
+    void check_prices(const Prices& prices, size_t num_rows) {
+        ASSERT_EQ(prices.size, num_rows);
+        ASSERT_EQ(prices.timestamps.size(), num_rows);
+        ASSERT_EQ(prices.symbol_ids.size(), num_rows);
+        for (size_t i = 0; i < num_rows; ++i) {
+            ASSERT_EQ(prices.timestamps[i], i * 3) << "Failed at row " << i;
+            ASSERT_EQ(prices.stock_ids[i], fmt::format("s-{}", i % 17)) << "Failed at row " << i;
+            ASSERT_EQ(prices.prices[i], i % 1000) << "Failed at row " << i;
+        }
+    }
+} // namespace
+
+TEST(relation, LoadMultipleChunks) {
+    size_t num_rows = 500'000;
+    auto path = write_csv(num_rows, /* header= */ true, /* trailing_newline= */ true);
+
+    Prices prices = load_prices(path);
+    check_prices(prices, num_rows);
+    std::remove(path.c_str());
+}
+
+TEST(relation, LoadWithoutTrailingNewline) {
+    size_t num_rows = 500'000;
+    auto path = write_csv(num_rows, /* header= */ false, /* trailing_newline= */ false);
+
+    Prices prices = load_prices(path);
+    check_prices(prices, num_rows);
+    std::remove(path.c_str());
+}
+
+TEST(relation, LoadPricesAndOrderBookConcurrently) {
+    auto [prices, order_book] = load_prices_and_order_book(
+        "../test/data/prices_small.csv", "../test/data/orderbook_small.csv");
+    Prices prices_serial = load_prices("../test/data/prices_small.csv");
+    OrderBook order_book_serial = load_order_book("../test/data/orderbook_small.csv");
+
+    ASSERT_EQ(prices.timestamps, prices_serial.timestamps);
+    ASSERT_EQ(prices.symbol_ids, prices_serial.symbol_ids);
+    ASSERT_EQ(prices.prices, prices_serial.prices);
+    ASSERT_EQ(order_book.timestamps, order_book_serial.timestamps);
+    ASSERT_EQ(order_book.symbol_ids, order_book_serial.symbol_ids);
+    ASSERT_EQ(order_book.amounts, order_book_serial.amounts);
+}
+
+TEST(relation, ResultRelationKeepsAllRows) {
+    ResultRelation result;
+    size_t num_rows = 1'000'000;
+    std::string_view stock_id = "s-1";
+    SymbolId symbol_id = SymbolDictionary::shared().encode(stock_id);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_rows),
+            [&](tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            if (i % 10 == 0) {
+                result.insert_unmatched(i, stock_id, symbol_id, 1);
+            } else {
+                result.insert(i, stock_id, i, i, stock_id, symbol_id, 2);
+            }
+        }
+    });
+    result.finalize();
+
+    ASSERT_EQ(result.size, num_rows);
+    ASSERT_EQ(result.num_unmatched, num_rows / 10);
+
+    auto columns = result.gather();
+    ASSERT_EQ(columns.values.size(), num_rows);
+
+    /// Every order occurs exactly once with its value.
+    std::vector<bool> seen(num_rows, false);
+    uint64_t value_sum = 0;
+    for (size_t i = 0; i < num_rows; ++i) {
+        auto order = columns.order_book_timestamps[i];
+        ASSERT_FALSE(seen[order]) << "Duplicate order " << order;
+        seen[order] = true;
+        ASSERT_EQ(columns.order_book_stock_ids[i], stock_id);
+
+        if (order % 10 == 0) {
+            ASSERT_EQ(columns.values[i], ResultRelation::NULL_VALUE);
+        } else {
+            ASSERT_EQ(columns.prices[i], order);
+            ASSERT_EQ(columns.values[i], order * 2);
+            value_sum += columns.values[i];
+        }
+    }
+    ASSERT_EQ(value_sum, result.value_sum);
+    ASSERT_EQ(result.collect_values(), columns.values);
+
+    result.reset();
+    ASSERT_EQ(result.size, 0);
+    ASSERT_EQ(result.value_sum, 0);
+    ASSERT_TRUE(result.gather().values.empty());
+}
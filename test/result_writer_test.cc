@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "fmt/format.h"
+
+#include "relation.hpp"
+#include "asof_join.hpp"
+#include "result_writer.hpp"
+
+namespace {
+    std::string read_file(const std::string& path) {
+        std::ifstream in(path);
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        return buffer.str();
+    }
+
+    std::string nullable(uint64_t value) {
+        return value == ResultRelation::NULL_VALUE ? "" : std::to_string(value);
+    }
+
+    /// Result spanning multiple blocks with unmatched rows and values of all digit counts.
+    void fill_result(ResultRelation& result, size_t num_rows) {
+        static const std::string stock_ids[3] = {"s-0", "s-1", "stock-2"};
+        SymbolId symbol_ids[3];
+        for (size_t i = 0; i < 3; ++i) {
+            symbol_ids[i] = SymbolDictionary::shared().encode(stock_ids[i]);
+        }
+        for (size_t i = 0; i < num_rows; ++i) {
+            uint64_t timestamp = i * 1'000'003;
+            if (i % 7 == 0) {
+                result.insert_unmatched(timestamp, stock_ids[i % 3], symbol_ids[i % 3], i % 100);
+            } else {
+                result.insert(timestamp - 1, stock_ids[i % 3], i % 2 ? i : UINT32_MAX,
+                              timestamp, stock_ids[i % 3], symbol_ids[i % 3], i % 100);
+            }
+        }
+        result.finalize();
+    }
+} // namespace
+
+TEST(result_writer, WriteCsv) {
+    ResultRelation result;
+    fill_result(result, 100'000);
+    std::string path = "/tmp/asof_join_result_writer_test.csv";
+    result_writer::write_csv(result, path);
+
+    auto columns = result.gather();
+    std::string expected = "price_timestamp,stock_id,price,order_book_timestamp,amount,value\n";
+    for (size_t i = 0; i < columns.values.size(); ++i) {
+        expected += fmt::format("{},{},{},{},{},{}\n",
+            nullable(columns.prices_timestamps[i]), columns.order_book_stock_ids[i],
+            nullable(columns.prices[i]), columns.order_book_timestamps[i],
+            columns.amounts[i], nullable(columns.values[i]));
+    }
+
+    ASSERT_EQ(read_file(path), expected);
+    std::remove(path.c_str());
+}
+
+TEST(result_writer, WriteCsvOfJoin) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+    OrderBook order_book = load_order_book("../test/data/orderbook_small.csv");
+    PartitioningRightASOFJoin join(prices, order_book, LESS_EQUAL_THAN, INNER);
+    join.join();
+
+    std::string path = "/tmp/asof_join_result_writer_test_join.csv";
+    result_writer::write_csv(join.result, path, ';');
+
+    auto csv = read_file(path);
+    ASSERT_TRUE(csv.starts_with("price_timestamp;stock_id;price;order_book_timestamp;amount;value\n"));
+    ASSERT_EQ(std::count(csv.begin(), csv.end(), '\n'), join.result.size + 1);
+    std::remove(path.c_str());
+}
+
+TEST(result_writer, BinaryRoundTrip) {
+    ResultRelation result;
+    fill_result(result, 100'000);
+    std::string path = fmt::format("/tmp/asof_join_result_writer_test{}", result_writer::FILE_EXTENSION);
+    result_writer::write_binary(result, path);
+
+    auto expected = result.gather();
+    auto loaded = result_writer::read_binary(path);
+    ASSERT_EQ(loaded.prices_timestamps, expected.prices_timestamps);
+    ASSERT_EQ(loaded.prices, expected.prices);
+    ASSERT_EQ(loaded.order_book_timestamps, expected.order_book_timestamps);
+    ASSERT_EQ(loaded.order_book_stock_ids, expected.order_book_stock_ids);
+    ASSERT_EQ(loaded.order_book_symbol_ids, expected.order_book_symbol_ids);
+    ASSERT_EQ(loaded.amounts, expected.amounts);
+    ASSERT_EQ(loaded.values, expected.values);
+    std::remove(path.c_str());
+}
+
+TEST(result_writer, WriteLateMaterializedJoin) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+    OrderBook order_book = load_order_book("../test/data/orderbook_small.csv");
+    PartitioningRightASOFJoin join(prices, order_book, LESS_EQUAL_THAN, LEFT, ASOFJoin::NO_MAX_LAG, LATE);
+    join.join();
+
+    std::string csv_path = "/tmp/asof_join_result_writer_test_late.csv";
+    result_writer::write_csv(join.result, csv_path);
+    auto csv = read_file(csv_path);
+    ASSERT_EQ(std::count(csv.begin(), csv.end(), '\n'), join.result.size + 1);
+    std::remove(csv_path.c_str());
+
+    std::string path = fmt::format("/tmp/asof_join_result_writer_test_late{}", result_writer::FILE_EXTENSION);
+    result_writer::write_binary(join.result, path);
+    auto expected = join.result.gather();
+    auto loaded = result_writer::read_binary(path);
+    ASSERT_EQ(loaded.prices_timestamps, expected.prices_timestamps);
+    ASSERT_EQ(loaded.prices, expected.prices);
+    ASSERT_EQ(loaded.order_book_stock_ids, expected.order_book_stock_ids);
+    ASSERT_EQ(loaded.order_book_symbol_ids, expected.order_book_symbol_ids);
+    ASSERT_EQ(loaded.values, expected.values);
+    std::remove(path.c_str());
+}
+
+TEST(result_writer, RejectInvalidFile) {
+    std::string path = "/tmp/asof_join_result_writer_test_invalid.res";
+    {
+        std::ofstream out(path);
+        out << std::string(256, '0');
+    }
+
+    ASSERT_THROW(result_writer::read_binary(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(result_writer, RejectCorruptDictionary) {
+    ResultRelation result;
+    fill_result(result, 1'000);
+    std::string path = fmt::format("/tmp/asof_join_result_writer_test_corrupt{}", result_writer::FILE_EXTENSION);
+    result_writer::write_binary(result, path);
+
+    result_writer::ResultFileHeader header{};
+    {
+        std::ifstream in(path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+    auto patch = [&](size_t offset, uint64_t value) {
+        std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(offset));
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    /// The second symbol ends before it starts.
+    patch(header.dictionary_offset + sizeof(uint64_t), 100);
+    ASSERT_THROW(result_writer::read_binary(path), std::runtime_error);
+
+    /// A row count whose column size overflows.
+    patch(offsetof(result_writer::ResultFileHeader, num_rows), UINT64_MAX / 4);
+    ASSERT_THROW(result_writer::read_binary(path), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -84,6 +84,26 @@ namespace {
             }
         }
     }
+
+    /// Less equal than has to find the last and greater equal than the first of equal keys.
+    void test_search_duplicates(const SearchFn& search_less_equal_than, const SearchFn& search_greater_equal_than) {
+        size_t n = 100;
+        size_t num_duplicates = 3;
+        std::vector<TestEntry> data;
+        for (size_t i = 0; i < n * num_duplicates; ++i) {
+            data.emplace_back(i / num_duplicates, i);
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            auto *last = search_less_equal_than(data, i);
+            ASSERT_TRUE(last != nullptr) << error_msg(i);
+            ASSERT_EQ(last->value, i * num_duplicates + num_duplicates - 1) << error_msg(i);
+
+            auto *first = search_greater_equal_than(data, i);
+            ASSERT_TRUE(first != nullptr) << error_msg(i);
+            ASSERT_EQ(first->value, i * num_duplicates) << error_msg(i);
+        }
+    }
 } // namespace
 
 TEST(binary_search, SearchLessThanSmall) {
@@ -109,3 +129,162 @@ TEST(interpolation_search, SearchLessThanSmall) {
 TEST(interpolation_search, SearchGreaterThanSmall) {
     test_search_greater_than_small(Interpolation::greater_equal_than<TestEntry>);
 }
+
+TEST(binary_search, SearchDuplicates) {
+    test_search_duplicates(Binary::less_equal_than<TestEntry>, Binary::greater_equal_than<TestEntry>);
+}
+
+TEST(exponential_search, SearchDuplicates) {
+    test_search_duplicates(Exponential::less_equal_than<TestEntry>, Exponential::greater_equal_than<TestEntry>);
+}
+
+TEST(interpolation_search, SearchDuplicates) {
+    test_search_duplicates(Interpolation::less_equal_than<TestEntry>, Interpolation::greater_equal_than<TestEntry>);
+}
+
+TEST(eytzinger_search, SearchLessThanSmall) {
+    test_search_less_than_small([](auto& data, uint64_t target) {
+        return Eytzinger::less_equal_than(data, Eytzinger::Layout(data), target);
+    });
+}
+
+TEST(eytzinger_search, SearchGreaterThanSmall) {
+    test_search_greater_than_small([](auto& data, uint64_t target) {
+        return Eytzinger::greater_equal_than(data, Eytzinger::Layout(data), target);
+    });
+}
+
+TEST(eytzinger_search, SearchDuplicates) {
+    test_search_duplicates(
+        [](auto& data, uint64_t target) {
+            return Eytzinger::less_equal_than(data, Eytzinger::Layout(data), target);
+        },
+        [](auto& data, uint64_t target) {
+            return Eytzinger::greater_equal_than(data, Eytzinger::Layout(data), target);
+        });
+}
+
+TEST(eytzinger_search, SearchAllSizes) {
+    /// Complete and incomplete trees.
+    for (size_t n = 0; n < 70; ++n) {
+        auto data = generate_data(n, /* data_gap= */ 2, /* offset= */ 1);
+        Eytzinger::Layout layout(data);
+        for (uint64_t target = 0; target < 2 * n + 3; ++target) {
+            ASSERT_EQ(Eytzinger::less_equal_than(data, layout, target), Binary::less_equal_than(data, target))
+                << fmt::format("For size {} and target {}", n, target);
+            ASSERT_EQ(Eytzinger::greater_equal_than(data, layout, target), Binary::greater_equal_than(data, target))
+                << fmt::format("For size {} and target {}", n, target);
+        }
+    }
+}
+
+TEST(kary_search, SearchLessThanSmall) {
+    test_search_less_than_small([](auto& data, uint64_t target) {
+        return KAry::less_equal_than(data, KAry::Layout(data), target);
+    });
+}
+
+TEST(kary_search, SearchGreaterThanSmall) {
+    test_search_greater_than_small([](auto& data, uint64_t target) {
+        return KAry::greater_equal_than(data, KAry::Layout(data), target);
+    });
+}
+
+TEST(kary_search, SearchDuplicates) {
+    test_search_duplicates(
+        [](auto& data, uint64_t target) {
+            return KAry::less_equal_than(data, KAry::Layout(data), target);
+        },
+        [](auto& data, uint64_t target) {
+            return KAry::greater_equal_than(data, KAry::Layout(data), target);
+        });
+}
+
+TEST(kary_search, SearchAllSizes) {
+    /// Single nodes, partially filled leaves and trees of three levels.
+    for (size_t n = 0; n < 800; n += (n < 100 ? 1 : 37)) {
+        auto data = generate_data(n, /* data_gap= */ 2, /* offset= */ 1);
+        KAry::Layout layout(data);
+        for (uint64_t target = 0; target < 2 * n + 3; ++target) {
+            ASSERT_EQ(KAry::less_equal_than(data, layout, target), Binary::less_equal_than(data, target))
+                << fmt::format("For size {} and target {}", n, target);
+            ASSERT_EQ(KAry::greater_equal_than(data, layout, target), Binary::greater_equal_than(data, target))
+                << fmt::format("For size {} and target {}", n, target);
+        }
+    }
+}
+
+TEST(learned_search, SearchLessThanSmall) {
+    test_search_less_than_small([](auto& data, uint64_t target) {
+        return Learned::less_equal_than(data, Learned::Layout(data), target);
+    });
+}
+
+TEST(learned_search, SearchGreaterThanSmall) {
+    test_search_greater_than_small([](auto& data, uint64_t target) {
+        return Learned::greater_equal_than(data, Learned::Layout(data), target);
+    });
+}
+
+TEST(learned_search, SearchDuplicates) {
+    test_search_duplicates(
+        [](auto& data, uint64_t target) {
+            return Learned::less_equal_than(data, Learned::Layout(data), target);
+        },
+        [](auto& data, uint64_t target) {
+            return Learned::greater_equal_than(data, Learned::Layout(data), target);
+        });
+}
+
+TEST(learned_search, SearchSkewedData) {
+    /// Bursts of dense and duplicate keys separated by large gaps, which need many spline knots.
+    std::vector<TestEntry> data;
+    uint64_t key = 1;
+    for (size_t burst = 0; burst < 50; ++burst) {
+        for (size_t i = 0; i < 200; ++i) {
+            data.emplace_back(key, data.size());
+            key += (i % 3 == 0) ? 0 : 1 + burst % 4;
+        }
+        key += 10'000 * (burst + 1);
+    }
+    Learned::Layout layout(data);
+    for (uint64_t target = 0; target < key + 2; target += (target % 10'000 < 1'000 ? 1 : 997)) {
+        ASSERT_EQ(Learned::less_equal_than(data, layout, target), Binary::less_equal_than(data, target))
+            << fmt::format("For target {}", target);
+        ASSERT_EQ(Learned::greater_equal_than(data, layout, target), Binary::greater_equal_than(data, target))
+            << fmt::format("For target {}", target);
+    }
+}
+
+TEST(interleaved_search, SearchMatchesBinarySearch) {
+    /// Bins of different sizes with duplicates, including an empty and a missing bin.
+    std::vector<std::vector<TestEntry>> data(4);
+    for (size_t i = 0; i < 1000; ++i) {
+        data[0].emplace_back(i / 3, i);
+        data[1].emplace_back(2 * i + 100, i);
+    }
+    data[3].emplace_back(50, 0);
+
+    std::vector<std::vector<TestEntry>*> bins;
+    std::vector<uint64_t> targets;
+    for (uint64_t target = 0; target < 2500; target += 7) {
+        for (size_t bin = 0; bin <= data.size(); ++bin) {
+            bins.push_back(bin < data.size() ? &data[bin] : nullptr);
+            targets.push_back(target);
+        }
+    }
+
+    std::vector<TestEntry*> less_equal(targets.size());
+    std::vector<TestEntry*> greater_equal(targets.size());
+    Interleaved::less_equal_than(bins.data(), targets.data(), targets.size(), less_equal.data());
+    Interleaved::greater_equal_than(bins.data(), targets.data(), targets.size(), greater_equal.data());
+
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (bins[i] == nullptr) {
+            ASSERT_TRUE(less_equal[i] == nullptr && greater_equal[i] == nullptr) << error_msg(i);
+            continue;
+        }
+        ASSERT_EQ(less_equal[i], Binary::less_equal_than(*bins[i], targets[i])) << error_msg(i);
+        ASSERT_EQ(greater_equal[i], Binary::greater_equal_than(*bins[i], targets[i])) << error_msg(i);
+    }
+}
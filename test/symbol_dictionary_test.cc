@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "fmt/format.h"
+
+#include "relation.hpp"
+#include "symbol_dictionary.hpp"
+
+
+TEST(symbol_dictionary, EncodeDecode) {
+    SymbolDictionary dictionary;
+
+    auto a = dictionary.encode("s-a");
+    auto b = dictionary.encode("s-b");
+
+    ASSERT_EQ(a, 0);
+    ASSERT_EQ(b, 1);
+    ASSERT_EQ(dictionary.encode("s-a"), a);
+    ASSERT_EQ(dictionary.decode(a), "s-a");
+    ASSERT_EQ(dictionary.decode(b), "s-b");
+    ASSERT_EQ(dictionary.size(), 2);
+}
+
+TEST(symbol_dictionary, EncodeColumnDense) {
+    SymbolDictionary dictionary;
+    size_t num_symbols = 1000;
+    size_t num_rows = 100000;
+
+    std::vector<std::string> column;
+    for (size_t i = 0; i < num_rows; ++i) {
+        column.push_back(fmt::format("s-{}", i % num_symbols));
+    }
+
+    auto ids = dictionary.encode(column);
+    ASSERT_EQ(ids.size(), num_rows);
+    ASSERT_EQ(dictionary.size(), num_symbols);
+
+    for (size_t i = 0; i < num_rows; ++i) {
+        ASSERT_LT(ids[i], num_symbols) << "Failed at row " << i;
+        ASSERT_EQ(dictionary.decode(ids[i]), column[i]) << "Failed at row " << i;
+    }
+
+    /// Encoding the column again must not add new symbols.
+    ASSERT_EQ(dictionary.encode(column), ids);
+    ASSERT_EQ(dictionary.size(), num_symbols);
+}
+
+TEST(symbol_dictionary, RelationsShareDictionary) {
+    Prices prices = load_prices("../test/data/prices_small.csv");
+    OrderBook order_book = load_order_book("../test/data/orderbook_small.csv");
+
+    for (size_t i = 0; i < order_book.size; ++i) {
+        for (size_t j = 0; j < prices.size; ++j) {
+            ASSERT_EQ(order_book.stock_ids[i] == prices.stock_ids[j],
+                      order_book.symbol_ids[i] == prices.symbol_ids[j]);
+        }
+    }
+}